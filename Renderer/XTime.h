@@ -1,22 +1,32 @@
 #pragma once // microsoft include guard for visual studio.
-#include "Windows.h" // needed for timer ops
+#include <chrono> // steady_clock, portable high resolution timing
+#include <cstdint>
+#include "frame_limiter.h"
 // XTime is a timer class desingned to be used by D3D11 grahpics applications.(use one per thread)
 // Use it for tracking time intervals in seconds with double percision.
 // It also supports weighted time smoothing for time based movement. (should not be used for tracking time)
 // Future versions may support uploading time data across multiple threads. (data sent to seperate thread profiler)
 // Author: L.Norri CD DRX FullSail University
 // Version: 1.2 - 1/21/2014  
+// Version: 1.3 - steady_clock instead of QueryPerformanceCounter, deltas kept in a ring buffer
+//                and the weighted smooth delta updated in O(1) per signal.
 class XTime
 {
+	using clock = std::chrono::steady_clock;
+
 	// per thread timing data
 	struct THREAD_DATA
 	{
-		LARGE_INTEGER signals[256], frequency, start;
+		double deltas[255]; // ring buffer of the last numSamples deltas (seconds)
+		clock::time_point start, lastSignal;
 		double totalTime, deltaTime, smoothDelta, blendWeight;
-		double samplesPerSecond, lastSecond, actualHz;
-		unsigned int threadID, elapsedSignals; 
-		unsigned char signalCount, numSamples;
+		double weightedSum, totalWeight, oldestWeight; // running weighted average, oldestWeight = blendWeight^(numSamples-1)
+		double samplesPerSecond, lastSecond;
+		uint64_t signalCount;
+		unsigned int elapsedSignals;
+		unsigned char numSamples, next; // next is the ring index written by the next signal (the oldest once full)
 	}localStack; // instance of timing data on this thread
+	end::frame_limiter_t limiter; // paces Throttle
 	
 public:
 	// Initialize the timer, 
@@ -44,14 +54,10 @@ public:
 	double SamplesPerSecond();
 	// Use the "targetHz" parameter to enable thread throttling.
 	// By default, thread throttling is not enabled "0". However by specifying a non-zero targetHz,
-	// the Throttle function will attempt to gradually adjust the threads speed to match the target Hz by calling "Sleep".
+	// the Throttle function will hold the thread to the target Hz with an end::frame_limiter_t
+	// (high resolution sleep close to the frame deadline, then a short spin), so it doesn't depend on
+	// the 15.6ms windows scheduler tick or "timeBeginPeriod".
 	// this function is best called once per frame per thread just like "Signal"
-	// ************************************* IMPORTANT *****************************************************************
-	// By default the fidelity of the thread scheduler is 15.6ms in windows.
-	// This means two "throttled" threads will likely not be able to communicate any faster than 32-64Hz.
-	// You can improve thread scheduling response (up to 500Hz) by calling the windows function
-	// "timeBeginPeriod(1)" at the start of your application followed by "timeEndPeriod(1)" at the end.
-	// Be aware this is a global setting and will increase total power consumption roughly 25%.
 	// If possible use an event/message based system instead for high speed threads. (favor using "Sync" below if possible)
 	void Throttle(double targetHz);
 	// Future Version: to be defined alongside a synchronization primitive.
@@ -0,0 +1,333 @@
+#include "archive.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "lz_codec.h"
+
+namespace end
+{
+	namespace
+	{
+		// Stored bytes per job when verifying in parallel
+		constexpr size_t VERIFY_CHUNK_SIZE = 1024 * 1024;
+
+		// values[0] is the bytewise table, values[k] advances a byte k more positions (slicing-by-8)
+		struct crc_table_t
+		{
+			uint32_t values[8][256];
+
+			constexpr crc_table_t() : values()
+			{
+				for (uint32_t i = 0; i < 256; i++)
+				{
+					uint32_t c = i;
+					for (int k = 0; k < 8; k++)
+						c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+					values[0][i] = c;
+				}
+				for (int k = 1; k < 8; k++)
+				{
+					for (uint32_t i = 0; i < 256; i++)
+						values[k][i] = (values[k - 1][i] >> 8) ^ values[0][values[k - 1][i] & 0xFF];
+				}
+			}
+		};
+
+		constexpr crc_table_t CRC_TABLE;
+
+		inline uint32_t read_le32(const uint8_t* p)
+		{
+			return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+		}
+
+		// CRC-32 as a GF(2) matrix, for moving a CRC past zero bytes
+		uint32_t gf2_times(const uint32_t* matrix, uint32_t vector)
+		{
+			uint32_t sum = 0;
+			for (; vector; vector >>= 1, matrix++)
+			{
+				if (vector & 1)
+					sum ^= *matrix;
+			}
+			return sum;
+		}
+
+		void gf2_square(uint32_t* square, const uint32_t* matrix)
+		{
+			for (int n = 0; n < 32; n++)
+				square[n] = gf2_times(matrix, matrix[n]);
+		}
+
+		size_t align_up(size_t value, size_t alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		void set_error(std::string* error, const std::string& message)
+		{
+			if (error)
+				*error = message;
+		}
+
+		// Writes zeros up to offset
+		bool pad_to(FILE* file, size_t& written, size_t offset)
+		{
+			static const uint8_t zeros[ARCHIVE_ALIGNMENT] = {};
+			while (written < offset)
+			{
+				size_t n = std::min(offset - written, sizeof(zeros));
+				if (fwrite(zeros, 1, n, file) != n)
+					return false;
+				written += n;
+			}
+			return true;
+		}
+	}
+
+	uint64_t archive_name_hash(const char* name)
+	{
+		uint64_t hash = 0xCBF29CE484222325ull;
+		for (const char* c = name; *c; c++)
+		{
+			uint8_t ch = (uint8_t)(*c == '\\' ? '/' : *c);
+			hash = (hash ^ ch) * 0x100000001B3ull;
+		}
+		return hash;
+	}
+
+	uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc)
+	{
+		const auto& t = CRC_TABLE.values;
+		crc = ~crc;
+
+		// 8 bytes per step through the sliced tables, then the tail a byte at a time
+		for (; size >= 8; data += 8, size -= 8)
+		{
+			uint32_t one = read_le32(data) ^ crc;
+			uint32_t two = read_le32(data + 4);
+			crc = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^ t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24] ^
+				t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^ t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+		}
+		for (; size; data++, size--)
+			crc = t[0][(crc ^ *data) & 0xFF] ^ (crc >> 8);
+		return ~crc;
+	}
+
+	uint32_t crc32_combine(uint32_t crc1, uint32_t crc2, size_t size2)
+	{
+		if (size2 == 0)
+			return crc1;
+
+		// Operators for 1 and 2 zero bits, squared up to the set bits of size2 (as in zlib)
+		uint32_t even[32], odd[32];
+		odd[0] = 0xEDB88320u;
+		for (int n = 1; n < 32; n++)
+			odd[n] = 1u << (n - 1);
+		gf2_square(even, odd);
+		gf2_square(odd, even);
+
+		uint64_t bytes = size2;
+		do
+		{
+			gf2_square(even, odd);
+			if (bytes & 1)
+				crc1 = gf2_times(even, crc1);
+			bytes >>= 1;
+			if (!bytes)
+				break;
+
+			gf2_square(odd, even);
+			if (bytes & 1)
+				crc1 = gf2_times(odd, crc1);
+			bytes >>= 1;
+		} while (bytes);
+
+		return crc1 ^ crc2;
+	}
+
+	bool write_archive(const char* path, const std::vector<archive_input_t>& inputs, std::string* error, job_system_t* jobs)
+	{
+		std::vector<archive_entry_t> entries(inputs.size());
+		std::vector<size_t> order(inputs.size());
+		std::vector<binary_blob_t> compressed(inputs.size());
+
+		for (size_t i = 0; i < inputs.size(); i++)
+		{
+			const binary_blob_t& data = inputs[i].data;
+			if (inputs[i].compress && !data.empty())
+			{
+				compressed[i] = lz_compress_chunked(data.data(), data.size(), LZ_DEFAULT_CHUNK_SIZE, jobs);
+				if (compressed[i].size() >= data.size())
+					compressed[i].clear();
+			}
+
+			const binary_blob_t& stored = compressed[i].empty() ? data : compressed[i];
+
+			archive_entry_t& e = entries[i];
+			memset(&e, 0, sizeof(e));
+			e.name_hash = archive_name_hash(inputs[i].name.c_str());
+			e.size = data.size();
+			e.stored_size = stored.size();
+			e.checksum = crc32(stored.data(), stored.size());
+			e.flags = compressed[i].empty() ? 0 : ARCHIVE_COMPRESSED;
+			order[i] = i;
+		}
+
+		// TOC sorted by hash, payloads in input order
+		std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return entries[a].name_hash < entries[b].name_hash; });
+		for (size_t i = 1; i < order.size(); i++)
+		{
+			if (entries[order[i]].name_hash == entries[order[i - 1]].name_hash)
+			{
+				set_error(error, "duplicate or colliding names: " + inputs[order[i - 1]].name + ", " + inputs[order[i]].name);
+				return false;
+			}
+		}
+
+		archive_header_t header;
+		memset(&header, 0, sizeof(header));
+		header.magic = ARCHIVE_MAGIC;
+		header.version = ARCHIVE_VERSION;
+		header.entry_count = entries.size();
+		header.toc_offset = sizeof(archive_header_t);
+
+		size_t offset = align_up(sizeof(archive_header_t) + entries.size() * sizeof(archive_entry_t), ARCHIVE_ALIGNMENT);
+		size_t data_end = sizeof(archive_header_t) + entries.size() * sizeof(archive_entry_t);
+		for (archive_entry_t& e : entries)
+		{
+			e.offset = offset;
+			data_end = offset + (size_t)e.stored_size;
+			offset = align_up(data_end, ARCHIVE_ALIGNMENT);
+		}
+		header.file_size = std::max(offset, data_end);
+
+		FILE* file = fopen(path, "wb");
+		if (!file)
+		{
+			set_error(error, std::string("can't open ") + path);
+			return false;
+		}
+
+		// Written front to back with zero padding, no seeks (long offsets are 32 bit on Windows)
+		bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+		for (size_t i : order)
+			ok = ok && fwrite(&entries[i], sizeof(archive_entry_t), 1, file) == 1;
+		size_t written = sizeof(archive_header_t) + entries.size() * sizeof(archive_entry_t);
+
+		for (size_t i = 0; i < inputs.size() && ok; i++)
+		{
+			const binary_blob_t& stored = compressed[i].empty() ? inputs[i].data : compressed[i];
+			ok = pad_to(file, written, (size_t)entries[i].offset);
+			if (ok && !stored.empty())
+				ok = fwrite(stored.data(), stored.size(), 1, file) == 1;
+			written += stored.size();
+		}
+
+		// Pad the last page so the file size matches the header
+		ok = ok && pad_to(file, written, (size_t)header.file_size);
+
+		if (fclose(file) != 0)
+			ok = false;
+		if (!ok)
+			set_error(error, std::string("write failed: ") + path);
+		return ok;
+	}
+
+	bool archive_t::open(const char* path)
+	{
+		close();
+
+		file = map_binary_blob(path);
+		if (file.size() < sizeof(archive_header_t))
+		{
+			close();
+			return false;
+		}
+
+		archive_header_t header;
+		memcpy(&header, file.data(), sizeof(header));
+
+		bool valid = header.magic == ARCHIVE_MAGIC && header.version >= 1 && header.version <= ARCHIVE_VERSION && header.file_size == file.size() &&
+			header.toc_offset % alignof(archive_entry_t) == 0 && header.toc_offset <= file.size() &&
+			header.entry_count <= (file.size() - header.toc_offset) / sizeof(archive_entry_t);
+		if (!valid)
+		{
+			close();
+			return false;
+		}
+
+		toc = (const archive_entry_t*)(file.data() + header.toc_offset);
+		count = (size_t)header.entry_count;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			bool compressed = (toc[i].flags & ARCHIVE_COMPRESSED) != 0;
+			if (toc[i].offset > file.size() || toc[i].stored_size > file.size() - toc[i].offset ||
+				(!compressed && toc[i].size != toc[i].stored_size))
+			{
+				close();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void archive_t::close()
+	{
+		file = mapped_blob_t{};
+		toc = nullptr;
+		count = 0;
+	}
+
+	const archive_entry_t* archive_t::find(const char* name)const
+	{
+		uint64_t hash = archive_name_hash(name);
+		const archive_entry_t* last = toc + count;
+		const archive_entry_t* it = std::lower_bound(toc, last, hash,
+			[](const archive_entry_t& e, uint64_t h) { return e.name_hash < h; });
+		return it != last && it->name_hash == hash ? it : nullptr;
+	}
+
+	blob_view_t archive_t::stored(const archive_entry_t& entry)const
+	{
+		return { file.data() + entry.offset, (size_t)entry.stored_size };
+	}
+
+	bool archive_t::verify(const archive_entry_t& entry, job_system_t* jobs)const
+	{
+		blob_view_t bytes = stored(entry);
+		if (!jobs || bytes.size() <= VERIFY_CHUNK_SIZE)
+			return crc32(bytes.data(), bytes.size()) == entry.checksum;
+
+		// A CRC per chunk, combined in order
+		size_t chunk_count = (bytes.size() + VERIFY_CHUNK_SIZE - 1) / VERIFY_CHUNK_SIZE;
+		std::vector<uint32_t> chunk_crcs(chunk_count);
+		jobs->parallel_for(bytes.size(), VERIFY_CHUNK_SIZE, [&](size_t first, size_t last)
+		{
+			chunk_crcs[first / VERIFY_CHUNK_SIZE] = crc32(bytes.data() + first, last - first);
+		});
+
+		uint32_t crc = chunk_crcs[0];
+		for (size_t c = 1; c < chunk_count; c++)
+		{
+			size_t chunk_size = std::min(VERIFY_CHUNK_SIZE, bytes.size() - c * VERIFY_CHUNK_SIZE);
+			crc = crc32_combine(crc, chunk_crcs[c], chunk_size);
+		}
+		return crc == entry.checksum;
+	}
+
+	bool archive_t::extract(const archive_entry_t& entry, uint8_t* dst, job_system_t* jobs)const
+	{
+		blob_view_t bytes = stored(entry);
+		if (!(entry.flags & ARCHIVE_COMPRESSED))
+		{
+			if (!bytes.empty())
+				memcpy(dst, bytes.data(), bytes.size());
+			return true;
+		}
+
+		return lz_decompress_chunked(bytes.data(), bytes.size(), dst, (size_t)entry.size, jobs);
+	}
+}
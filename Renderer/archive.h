@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "blob.h"
+#include "job_system.h"
+
+namespace end
+{
+	// Packed asset archive.
+	//
+	//	header | table of contents | payloads
+	//	The TOC is sorted by name hash for a binary search, every payload starts on a 4 KB page
+	//	so entries can be used straight out of one mapping of the whole file.
+	//	All integers are little endian. Names are hashed with '\' turned into '/'.
+	//	Version 2 added compressed entries (lz_codec chunked streams), version 1 files still open.
+
+	constexpr uint32_t ARCHIVE_MAGIC = 0x41444E45; // "ENDA"
+	constexpr uint32_t ARCHIVE_VERSION = 2;
+	constexpr size_t ARCHIVE_ALIGNMENT = 4096;
+
+	// archive_entry_t::flags
+	constexpr uint32_t ARCHIVE_COMPRESSED = 1 << 0;
+
+	struct archive_header_t
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t entry_count;
+		uint64_t toc_offset;
+		uint64_t file_size;
+		uint8_t reserved[32];
+	};
+	static_assert(sizeof(archive_header_t) == 64, "archive header layout");
+
+	struct archive_entry_t
+	{
+		uint64_t name_hash;
+		uint64_t offset;		// from the start of the file, page aligned
+		uint64_t size;			// bytes once loaded
+		uint64_t stored_size;	// bytes in the file
+		uint32_t checksum;		// CRC-32 of the stored bytes
+		uint32_t flags;
+		uint64_t reserved;
+	};
+	static_assert(sizeof(archive_entry_t) == 48, "archive entry layout");
+
+	// FNV-1a 64, path separators normalized
+	uint64_t archive_name_hash(const char* name);
+
+	// CRC-32 (IEEE), 8 bytes per step. crc continues a previous call.
+	uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0);
+
+	// CRC of A followed by B from crc32(A), crc32(B) and B's size, so parts can be summed in parallel
+	uint32_t crc32_combine(uint32_t crc1, uint32_t crc2, size_t size2);
+
+	struct archive_input_t
+	{
+		std::string name;
+		binary_blob_t data;
+		bool compress = false; // kept raw anyway if it doesn't get smaller
+	};
+
+	// Packer side, false (with a message in error) on duplicate names or a write failure.
+	// jobs, if given, compresses chunks in parallel.
+	bool write_archive(const char* path, const std::vector<archive_input_t>& inputs, std::string* error = nullptr,
+		job_system_t* jobs = nullptr);
+
+	// Reader over one mapping of the archive (map_binary_blob, so a buffered read if mapping fails)
+	class archive_t
+	{
+	public:
+
+		// false if missing or not a valid archive
+		bool open(const char* path);
+		void close();
+
+		bool is_open()const { return toc != nullptr; }
+		size_t entry_count()const { return count; }
+
+		// nullptr if the archive has no such name
+		const archive_entry_t* find(const char* name)const;
+
+		// Stored bytes of an entry, pointing into the mapping
+		blob_view_t stored(const archive_entry_t& entry)const;
+
+		// Reads every stored byte, so it also pages the entry in.
+		// Large entries are checked a 1 MB slice per job when there is a job system.
+		bool verify(const archive_entry_t& entry, job_system_t* jobs = nullptr)const;
+
+		// Writes the entry's entry.size loaded bytes to dst, decompressing if needed
+		// (a chunk per job when there is a job system). false on corrupt data.
+		bool extract(const archive_entry_t& entry, uint8_t* dst, job_system_t* jobs = nullptr)const;
+
+	private:
+
+		mapped_blob_t file;
+		const archive_entry_t* toc = nullptr;
+		size_t count = 0;
+	};
+}
@@ -0,0 +1,202 @@
+#include "asset_loader.h"
+
+#include "profiler.h"
+
+namespace end
+{
+	namespace
+	{
+		constexpr size_t PAGE_SIZE = 4096;
+
+		// Reads one byte per page so a mapped file is paged in here rather than on first use
+		void touch_pages(const blob_view_t& blob)
+		{
+			volatile uint8_t sink = 0;
+			for (size_t i = 0; i < blob.size(); i += PAGE_SIZE)
+				sink = sink + blob.data()[i];
+		}
+	}
+
+	asset_loader_t::asset_loader_t(int io_threads, job_system_t* jobs) : jobs(jobs)
+	{
+		if (io_threads < 1)
+			io_threads = 1;
+
+		for (int i = 0; i < io_threads; i++)
+			this->io_threads.emplace_back(&asset_loader_t::io_loop, this);
+	}
+
+	asset_loader_t::~asset_loader_t()
+	{
+		{
+			std::lock_guard<std::mutex> guard(queue_lock);
+			quit = true;
+		}
+		request_ready.notify_all();
+
+		for (std::thread& t : io_threads)
+			t.join();
+	}
+
+	bool asset_loader_t::mount(const char* archive_path)
+	{
+		std::unique_ptr<archive_t> archive(new archive_t);
+		if (!archive->open(archive_path))
+			return false;
+
+		archives.insert(archives.begin(), std::move(archive));
+		return true;
+	}
+
+	asset_handle_t asset_loader_t::load(const char* path, callback_t on_loaded)
+	{
+		asset_handle_t handle;
+		{
+			std::lock_guard<std::mutex> guard(assets_lock);
+			handle = (asset_handle_t)assets.size();
+			assets.emplace_back();
+			assets.back().path = path;
+			assets.back().on_loaded = std::move(on_loaded);
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(queue_lock);
+			requests.push_back(handle);
+			in_flight++;
+		}
+		request_ready.notify_one();
+		return handle;
+	}
+
+	asset_state_t asset_loader_t::state(asset_handle_t handle)const
+	{
+		std::lock_guard<std::mutex> guard(assets_lock);
+		return (asset_state_t)assets[handle].state.load(std::memory_order_acquire);
+	}
+
+	blob_view_t asset_loader_t::blob(asset_handle_t handle)const
+	{
+		std::lock_guard<std::mutex> guard(assets_lock);
+		return assets[handle].view;
+	}
+
+	void asset_loader_t::release(asset_handle_t handle)
+	{
+		std::lock_guard<std::mutex> guard(assets_lock);
+		if (assets[handle].state.load(std::memory_order_acquire) != ASSET_PENDING)
+		{
+			assets[handle].file = mapped_blob_t{};
+			assets[handle].buffer = binary_blob_t{};
+			assets[handle].view = blob_view_t{};
+		}
+	}
+
+	size_t asset_loader_t::update()
+	{
+		std::vector<asset_handle_t> done;
+		{
+			std::lock_guard<std::mutex> guard(queue_lock);
+			done.swap(finished);
+		}
+
+		for (asset_handle_t handle : done)
+		{
+			asset_t* asset;
+			{
+				std::lock_guard<std::mutex> guard(assets_lock);
+				asset = &assets[handle];
+			}
+
+			if (asset->on_loaded)
+				asset->on_loaded(handle, asset->view);
+		}
+
+		if (!done.empty())
+		{
+			std::lock_guard<std::mutex> guard(queue_lock);
+			in_flight -= done.size();
+		}
+		return done.size();
+	}
+
+	void asset_loader_t::wait_all()
+	{
+		for (;;)
+		{
+			update();
+
+			std::unique_lock<std::mutex> lock(queue_lock);
+			if (in_flight == 0)
+				return;
+
+			load_finished.wait(lock, [this] { return !finished.empty(); });
+		}
+	}
+
+	void asset_loader_t::read(asset_t& asset)const
+	{
+		PROFILE_SCOPE("load asset");
+
+		for (const auto& archive : archives)
+		{
+			if (const archive_entry_t* entry = archive->find(asset.path.c_str()))
+			{
+				// The checksum pass reads every byte, so no separate touch
+				if (!archive->verify(*entry, jobs))
+					return;
+
+				if (entry->flags & ARCHIVE_COMPRESSED)
+				{
+					PROFILE_SCOPE("decompress asset");
+					asset.buffer.resize((size_t)entry->size);
+					if (archive->extract(*entry, asset.buffer.data(), jobs))
+						asset.view = { asset.buffer.data(), asset.buffer.size() };
+					else
+						asset.buffer = binary_blob_t{};
+				}
+				else
+					asset.view = archive->stored(*entry);
+				return;
+			}
+		}
+
+		asset.file = map_binary_blob(asset.path.c_str());
+		asset.view = asset.file.view();
+		if (asset.file.is_mapped())
+			touch_pages(asset.view);
+	}
+
+	void asset_loader_t::io_loop()
+	{
+		profiler::set_thread_name("asset io");
+
+		for (;;)
+		{
+			asset_handle_t handle;
+			{
+				std::unique_lock<std::mutex> lock(queue_lock);
+				request_ready.wait(lock, [this] { return quit || !requests.empty(); });
+				if (quit)
+					return;
+
+				handle = requests.front();
+				requests.pop_front();
+			}
+
+			asset_t* asset;
+			{
+				std::lock_guard<std::mutex> guard(assets_lock);
+				asset = &assets[handle];
+			}
+
+			read(*asset);
+			asset->state.store(asset->view.empty() ? ASSET_FAILED : ASSET_READY, std::memory_order_release);
+
+			{
+				std::lock_guard<std::mutex> guard(queue_lock);
+				finished.push_back(handle);
+			}
+			load_finished.notify_all();
+		}
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "archive.h"
+#include "blob.h"
+#include "job_system.h"
+
+namespace end
+{
+	using asset_handle_t = uint32_t;
+
+	enum asset_state_t : uint8_t
+	{
+		ASSET_PENDING,	// queued or being read
+		ASSET_READY,	// read, callback may not have run yet
+		ASSET_FAILED	// missing, empty or failed its checksum
+	};
+
+	// Reads files on a few I/O threads while the caller keeps working.
+	//
+	//	load() only queues the file and returns a handle. Names found in a mounted archive come
+	//	straight out of its mapping (checksum verified), anything else is mapped as a loose file.
+	//	Compressed archive entries are decompressed into a buffer on the I/O thread, split across the
+	//	job system's workers when the loader has one.
+	//	Either way an I/O thread touches every page so the data is resident by the time it's used.
+	//	Callbacks never run on the I/O threads: update() / wait_all() run them on the calling (main) thread,
+	//	in completion order, which is where device objects can be made from the bytes.
+	//	Handles stay valid until the loader is destroyed, release() only frees the bytes.
+	class asset_loader_t
+	{
+	public:
+
+		// Called with the handle and the file's bytes (empty if it failed)
+		using callback_t = std::function<void(asset_handle_t handle, const blob_view_t& blob)>;
+
+		explicit asset_loader_t(int io_threads = 2, job_system_t* jobs = nullptr);
+		~asset_loader_t();
+
+		asset_loader_t(const asset_loader_t&) = delete;
+		asset_loader_t& operator=(const asset_loader_t&) = delete;
+
+		// Searched before loose files, latest first. Mount before issuing the loads it should serve.
+		bool mount(const char* archive_path);
+
+		asset_handle_t load(const char* path, callback_t on_loaded = nullptr);
+
+		asset_state_t state(asset_handle_t handle)const;
+
+		// Valid once state() isn't ASSET_PENDING
+		blob_view_t blob(asset_handle_t handle)const;
+
+		void release(asset_handle_t handle);
+
+		// Runs the callbacks of loads finished so far, returns how many ran
+		size_t update();
+
+		// Blocks until every load issued so far has finished and its callback ran
+		void wait_all();
+
+	private:
+
+		struct asset_t
+		{
+			std::string path;
+			mapped_blob_t file;		// loose files only
+			binary_blob_t buffer;	// decompressed archive entries only
+			blob_view_t view;
+			callback_t on_loaded;
+			std::atomic<uint8_t> state{ ASSET_PENDING };
+		};
+
+		void io_loop();
+		void read(asset_t& asset)const;
+
+		std::vector<std::unique_ptr<archive_t>> archives;
+		job_system_t* jobs;
+
+		// deque so assets don't move while I/O threads fill them
+		std::deque<asset_t> assets;
+		mutable std::mutex assets_lock;
+
+		std::deque<asset_handle_t> requests;
+		std::vector<asset_handle_t> finished;
+		std::mutex queue_lock;
+		std::condition_variable request_ready;
+		std::condition_variable load_finished;
+		size_t in_flight = 0; // loaded whose callbacks haven't run
+		bool quit = false;
+
+		std::vector<std::thread> io_threads;
+	};
+}
@@ -1,6 +1,21 @@
-
 #include "blob.h"
 #include <fstream>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace end
 {
@@ -13,14 +28,139 @@ namespace end
 		if (file.is_open())
 		{
 			file.seekg(0, std::ios_base::end);
-			blob.resize(file.tellg());
-			file.seekg(0, std::ios_base::beg);
+			std::streamoff size = file.tellg();
+			if (size > 0)
+			{
+				blob.resize((size_t)size);
+				file.seekg(0, std::ios_base::beg);
 
-			file.read((char*)blob.data(), blob.size());
+				file.read((char*)blob.data(), blob.size());
+				if (!file)
+					blob.clear();
+			}
 
 			file.close();
 		}
 
-		return std::move(blob);
+		return blob;
+	}
+
+	namespace
+	{
+		// Maps the whole file read-only, nullptr (and size 0) if it can't
+		void* map_file(const char* path, size_t& size)
+		{
+			size = 0;
+#if defined(_WIN32)
+			HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+				return nullptr;
+
+			LARGE_INTEGER file_size;
+			void* view = nullptr;
+			if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+			{
+				// The view keeps the mapping alive, both handles can go right away
+				HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (mapping)
+				{
+					view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+					CloseHandle(mapping);
+				}
+			}
+			CloseHandle(file);
+
+			if (view)
+				size = (size_t)file_size.QuadPart;
+			return view;
+#else
+			int fd = open(path, O_RDONLY);
+			if (fd < 0)
+				return nullptr;
+
+			struct stat st;
+			void* view = nullptr;
+			if (fstat(fd, &st) == 0 && st.st_size > 0)
+			{
+				view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (view == MAP_FAILED)
+					view = nullptr;
+			}
+			close(fd);
+
+			if (view)
+				size = (size_t)st.st_size;
+			return view;
+#endif
+		}
+
+		void unmap_file(void* view, size_t size)
+		{
+#if defined(_WIN32)
+			(void)size;
+			UnmapViewOfFile(view);
+#else
+			munmap(view, size);
+#endif
+		}
+	}
+
+	mapped_blob_t::~mapped_blob_t()
+	{
+		release();
+	}
+
+	mapped_blob_t::mapped_blob_t(mapped_blob_t&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	mapped_blob_t& mapped_blob_t::operator=(mapped_blob_t&& other) noexcept
+	{
+		if (this != &other)
+		{
+			release();
+
+			// A moved vector keeps its storage, so bytes still points at the right place
+			bytes = other.bytes;
+			length = other.length;
+			mapping = other.mapping;
+			buffer = std::move(other.buffer);
+
+			other.bytes = nullptr;
+			other.length = 0;
+			other.mapping = nullptr;
+		}
+		return *this;
+	}
+
+	void mapped_blob_t::release()
+	{
+		if (mapping)
+			unmap_file(mapping, length);
+
+		mapping = nullptr;
+		bytes = nullptr;
+		length = 0;
+		buffer = binary_blob_t{};
+	}
+
+	mapped_blob_t map_binary_blob(const char* path)
+	{
+		mapped_blob_t blob;
+
+		size_t size = 0;
+		if (void* view = map_file(path, size))
+		{
+			blob.mapping = view;
+			blob.bytes = (const uint8_t*)view;
+			blob.length = size;
+			return blob;
+		}
+
+		blob.buffer = load_binary_blob(path);
+		blob.bytes = blob.buffer.data();
+		blob.length = blob.buffer.size();
+		return blob;
 	}
-}
\ No newline at end of file
+}
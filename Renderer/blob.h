@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -7,5 +8,62 @@ namespace end
 {
 	using binary_blob_t = std::vector<uint8_t>;
 
+	// Whole file copied into memory, empty if it couldn't be read
 	binary_blob_t load_binary_blob(const char* path);
-}
\ No newline at end of file
+
+	// Non-owning bytes, e.g. a mapped file or one entry of an archive
+	struct blob_view_t
+	{
+		const uint8_t* bytes = nullptr;
+		size_t length = 0;
+
+		const uint8_t* data()const { return bytes; }
+		size_t size()const { return length; }
+		bool empty()const { return length == 0; }
+	};
+
+	// Read-only view of a whole file.
+	//
+	//	Memory-mapped when the OS allows it (mmap, or a file mapping on Windows) so nothing is copied
+	//	and pages load as they're touched, otherwise the file is read into a buffer the view owns.
+	//	Unmaps/frees on destruction, move-only.
+	class mapped_blob_t
+	{
+	public:
+
+		mapped_blob_t() = default;
+		~mapped_blob_t();
+
+		mapped_blob_t(mapped_blob_t&& other) noexcept;
+		mapped_blob_t& operator=(mapped_blob_t&& other) noexcept;
+
+		mapped_blob_t(const mapped_blob_t&) = delete;
+		mapped_blob_t& operator=(const mapped_blob_t&) = delete;
+
+		const uint8_t* data()const { return bytes; }
+		size_t size()const { return length; }
+		bool empty()const { return length == 0; }
+
+		const uint8_t* begin()const { return bytes; }
+		const uint8_t* end()const { return bytes + length; }
+
+		// false when the contents came from the buffered fallback
+		bool is_mapped()const { return mapping != nullptr; }
+
+		blob_view_t view()const { return { bytes, length }; }
+
+	private:
+
+		friend mapped_blob_t map_binary_blob(const char* path);
+
+		void release();
+
+		const uint8_t* bytes = nullptr;
+		size_t length = 0;
+		void* mapping = nullptr; // start of the mapped view
+		binary_blob_t buffer;	 // fallback contents
+	};
+
+	// Empty if the file couldn't be opened
+	mapped_blob_t map_binary_blob(const char* path);
+}
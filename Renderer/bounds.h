@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+
+#include "math_types.h"
+
+namespace end
+{
+	// Axis aligned box in world space.
+	// Plain data (no DirectX types) so CPU-side systems such as culling and queries
+	// can share it and run without a device.
+	struct aabb_t
+	{
+		float3 min;
+		float3 max;
+
+		inline float3 center()const { return (min + max) * 0.5f; }
+		inline float3 extents()const { return (max - min) * 0.5f; }
+
+		// Writes the 8 corners, bit 0/1/2 of the index selects max.x/y/z
+		inline void corners(float3 out[8])const
+		{
+			for (int i = 0; i < 8; i++)
+				out[i] = { (i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z };
+		}
+	};
+
+	// Non-owning structure-of-arrays boxes, what the batched (SIMD) kernels read.
+	struct aabb_soa_view_t
+	{
+		const float* min_x = nullptr;
+		const float* min_y = nullptr;
+		const float* min_z = nullptr;
+		const float* max_x = nullptr;
+		const float* max_y = nullptr;
+		const float* max_z = nullptr;
+		size_t count = 0;
+
+		inline aabb_t get(size_t i)const
+		{
+			return { { min_x[i], min_y[i], min_z[i] }, { max_x[i], max_y[i], max_z[i] } };
+		}
+	};
+
+	// Structure-of-arrays box storage
+	struct aabb_soa_t
+	{
+		std::vector<float> min_x, min_y, min_z;
+		std::vector<float> max_x, max_y, max_z;
+
+		inline size_t size()const { return min_x.size(); }
+
+		inline void resize(size_t n)
+		{
+			min_x.resize(n); min_y.resize(n); min_z.resize(n);
+			max_x.resize(n); max_y.resize(n); max_z.resize(n);
+		}
+
+		inline void clear() { resize(0); }
+
+		inline void set(size_t i, const aabb_t& box)
+		{
+			min_x[i] = box.min.x; min_y[i] = box.min.y; min_z[i] = box.min.z;
+			max_x[i] = box.max.x; max_y[i] = box.max.y; max_z[i] = box.max.z;
+		}
+
+		inline void push_back(const aabb_t& box)
+		{
+			resize(size() + 1);
+			set(size() - 1, box);
+		}
+
+		inline aabb_t get(size_t i)const { return view().get(i); }
+
+		inline aabb_soa_view_t view()const
+		{
+			return { min_x.data(), min_y.data(), min_z.data(), max_x.data(), max_y.data(), max_z.data(), size() };
+		}
+	};
+}
@@ -0,0 +1,170 @@
+#include "broadphase.h"
+
+#include <algorithm>
+
+namespace end
+{
+	uint32_t sap_broadphase_t::add(const aabb_t& box)
+	{
+		uint32_t handle;
+		if (!free_handles.empty())
+		{
+			handle = free_handles.back();
+			free_handles.pop_back();
+			boxes[handle] = box;
+			alive[handle] = 1;
+		}
+		else
+		{
+			handle = (uint32_t)boxes.size();
+			boxes.push_back(box);
+			alive.push_back(1);
+		}
+
+		// Appended at the end, update() sorts them into place and reports the new pairs
+		for (int axis = 0; axis < 3; axis++)
+		{
+			axes[axis].push_back({ box.min[axis], handle });
+			axes[axis].push_back({ box.max[axis], handle | MAX_FLAG });
+		}
+
+		return handle;
+	}
+
+	void sap_broadphase_t::remove(uint32_t handle)
+	{
+		for (auto it = pairs.begin(); it != pairs.end();)
+		{
+			uint32_t a = (uint32_t)(*it >> 32);
+			uint32_t b = (uint32_t)(*it & 0xFFFFFFFFu);
+			if (a == handle || b == handle)
+			{
+				removed_events.push_back({ a, b });
+				it = pairs.erase(it);
+			}
+			else
+				++it;
+		}
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			auto& ep = axes[axis];
+			ep.erase(std::remove_if(ep.begin(), ep.end(), [handle](const endpoint_t& e) { return (e.id & ~MAX_FLAG) == handle; }), ep.end());
+		}
+
+		alive[handle] = 0;
+		free_handles.push_back(handle);
+	}
+
+	void sap_broadphase_t::move(uint32_t handle, const aabb_t& box)
+	{
+		if (!alive[handle])
+			return;
+
+		boxes[handle] = box;
+	}
+
+	void sap_broadphase_t::update()
+	{
+		begin_events.clear();
+		end_events.clear();
+
+		// Pairs of removed boxes go first, their handles may already be reused by pairs that begin below
+		end_events.swap(removed_events);
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			// Pull in the moved values, order is fixed up by the sort
+			for (endpoint_t& e : axes[axis])
+			{
+				const aabb_t& box = boxes[e.id & ~MAX_FLAG];
+				e.value = (e.id & MAX_FLAG) ? box.max[axis] : box.min[axis];
+			}
+
+			sort_axis(axis);
+		}
+	}
+
+	void sap_broadphase_t::sort_axis(int axis)
+	{
+		std::vector<endpoint_t>& ep = axes[axis];
+
+		for (size_t i = 1; i < ep.size(); i++)
+		{
+			endpoint_t cur = ep[i];
+			size_t j = i;
+
+			while (j > 0 && sorts_after(ep[j - 1], cur))
+			{
+				const endpoint_t& prev = ep[j - 1];
+
+				uint32_t cur_handle = cur.id & ~MAX_FLAG;
+				uint32_t prev_handle = prev.id & ~MAX_FLAG;
+				bool cur_is_max = (cur.id & MAX_FLAG) != 0;
+				bool prev_is_max = (prev.id & MAX_FLAG) != 0;
+
+				if (cur_handle != prev_handle)
+				{
+					if (!cur_is_max && prev_is_max)
+					{
+						// A min moved below a max, the boxes may have started overlapping
+						if (overlaps(boxes[cur_handle], boxes[prev_handle]) && pairs.insert(pair_key(cur_handle, prev_handle)).second)
+							begin_events.push_back({ std::min(cur_handle, prev_handle), std::max(cur_handle, prev_handle) });
+					}
+					else if (cur_is_max && !prev_is_max)
+					{
+						// A max moved below a min, separated on this axis
+						if (pairs.erase(pair_key(cur_handle, prev_handle)))
+							end_events.push_back({ std::min(cur_handle, prev_handle), std::max(cur_handle, prev_handle) });
+					}
+				}
+
+				ep[j] = prev;
+				j--;
+			}
+
+			ep[j] = cur;
+		}
+	}
+
+	bool sap_broadphase_t::overlapping(uint32_t a, uint32_t b)const
+	{
+		return pairs.count(pair_key(a, b)) != 0;
+	}
+
+	void sap_broadphase_t::get_pairs(std::vector<overlap_pair_t>& out)const
+	{
+		out.clear();
+		out.reserve(pairs.size());
+		for (uint64_t key : pairs)
+			out.push_back({ (uint32_t)(key >> 32), (uint32_t)(key & 0xFFFFFFFFu) });
+
+		// unordered_set order isn't stable, keep the output reproducible
+		std::sort(out.begin(), out.end(), [](const overlap_pair_t& l, const overlap_pair_t& r)
+		{
+			return l.a != r.a ? l.a < r.a : l.b < r.b;
+		});
+	}
+
+	uint64_t sap_broadphase_t::pair_key(uint32_t a, uint32_t b)
+	{
+		if (a > b)
+			std::swap(a, b);
+		return ((uint64_t)a << 32) | b;
+	}
+
+	bool sap_broadphase_t::sorts_after(const endpoint_t& l, const endpoint_t& r)
+	{
+		// On equal values mins go first, so touching boxes are in overlap order like overlaps() says
+		if (l.value != r.value)
+			return l.value > r.value;
+		return (l.id & MAX_FLAG) && !(r.id & MAX_FLAG);
+	}
+
+	bool sap_broadphase_t::overlaps(const aabb_t& a, const aabb_t& b)
+	{
+		return a.min.x <= b.max.x && b.min.x <= a.max.x &&
+			a.min.y <= b.max.y && b.min.y <= a.max.y &&
+			a.min.z <= b.max.z && b.min.z <= a.max.z;
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+#include "bounds.h"
+
+namespace end
+{
+	// Two overlapping boxes, a < b
+	struct overlap_pair_t
+	{
+		uint32_t a;
+		uint32_t b;
+	};
+
+	// Incremental sweep-and-prune broadphase for box vs box overlap pairs.
+	//
+	//	Keeps the min/max endpoints of every box sorted along x, y and z.
+	//	update() re-sorts them with insertion sort, which is close to linear when
+	//	boxes only move a little between frames. Every swap of a min past a max
+	//	is where a pair can start or stop overlapping, so pairs are tracked from
+	//	the swaps instead of testing all boxes against each other.
+	//
+	//	Boxes touching exactly on a face count as overlapping.
+	class sap_broadphase_t
+	{
+	public:
+
+		// Returns the handle for the box, handles of removed boxes get reused
+		uint32_t add(const aabb_t& box);
+
+		// Pairs with the box are reported as ended by the next update()
+		void remove(uint32_t handle);
+
+		// New bounds, applied by the next update()
+		void move(uint32_t handle, const aabb_t& box);
+
+		// Sorts the endpoints and fills the begin/end events for this frame
+		void update();
+
+		const aabb_t& bounds(uint32_t handle)const { return boxes[handle]; }
+
+		// Pairs that started or stopped overlapping during the last update(), ended() also has the pairs of boxes removed before it
+		const std::vector<overlap_pair_t>& begun()const { return begin_events; }
+		const std::vector<overlap_pair_t>& ended()const { return end_events; }
+
+		bool overlapping(uint32_t a, uint32_t b)const;
+		size_t pair_count()const { return pairs.size(); }
+		void get_pairs(std::vector<overlap_pair_t>& out)const;
+
+	private:
+
+		// Bit 31 of the id marks a max endpoint
+		static constexpr uint32_t MAX_FLAG = 0x80000000u;
+
+		struct endpoint_t
+		{
+			float value;
+			uint32_t id;
+		};
+
+		static uint64_t pair_key(uint32_t a, uint32_t b);
+		static bool sorts_after(const endpoint_t& l, const endpoint_t& r);
+		static bool overlaps(const aabb_t& a, const aabb_t& b);
+
+		void sort_axis(int axis);
+
+		std::vector<endpoint_t> axes[3];
+		std::vector<aabb_t> boxes;
+		std::vector<uint8_t> alive;
+		std::vector<uint32_t> free_handles;
+
+		std::unordered_set<uint64_t> pairs;
+		std::vector<overlap_pair_t> begin_events;
+		std::vector<overlap_pair_t> end_events;
+		std::vector<overlap_pair_t> removed_events; // from remove(), waiting for the next update()
+	};
+}
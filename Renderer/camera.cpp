@@ -0,0 +1,70 @@
+#include "camera.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace end
+{
+	namespace
+	{
+		// Just under 90 degrees, the forward vector never lines up with world up
+		constexpr float MAX_PITCH = 1.55f;
+	}
+
+	void camera_t::look_at(const float3& eye, const float3& target)
+	{
+		vec3 dir = normalize(to_vec3(target) - to_vec3(eye));
+
+		pos = eye;
+		yaw_angle = std::atan2(get_x(dir), get_z(dir));
+		pitch_angle = std::clamp(std::asin(-get_y(dir)), -MAX_PITCH, MAX_PITCH);
+		pending = {};
+		update();
+	}
+
+	void camera_t::set_pose(const float3& p, float yaw, float pitch)
+	{
+		pos = p;
+		yaw_angle = yaw;
+		pitch_angle = std::clamp(pitch, -MAX_PITCH, MAX_PITCH);
+		pending = {};
+		update();
+	}
+
+	void camera_t::add_input(const camera_input_t& input)
+	{
+		pending.move += input.move;
+		pending.yaw += input.yaw;
+		pending.pitch += input.pitch;
+	}
+
+	quat camera_t::orientation()const
+	{
+		// Pitch about the camera's x, then yaw about world up
+		return quat_axis_angle(make_vec3(1.0f, 0.0f, 0.0f), pitch_angle) * quat_axis_angle(make_vec3(0.0f, 1.0f, 0.0f), yaw_angle);
+	}
+
+	void camera_t::update()
+	{
+		yaw_angle = std::remainder(yaw_angle + pending.yaw, 6.28318531f);
+		pitch_angle = std::clamp(pitch_angle + pending.pitch, -MAX_PITCH, MAX_PITCH);
+
+		mat4 rotation = to_mat4(orientation());
+		vec3 right = { rotation.r[0] };
+		vec3 up = { rotation.r[1] };
+		vec3 forward = { rotation.r[2] };
+
+		vec3 p = to_vec3(pos) + right * pending.move.x + forward * pending.move.z + make_vec3(0.0f, pending.move.y, 0.0f);
+		pos = to_float3(p);
+		pending = {};
+
+		mat4 world = rotation;
+		world.r[3] = make_vec4(p, 1.0f).r;
+		world_mtx = to_float4x4(world);
+
+		// Rigid inverse: transposed rotation, translation brought back by it
+		mat4 view = transpose(rotation);
+		view.r[3] = make_vec4(-dot(p, right), -dot(p, up), -dot(p, forward), 1.0f).r;
+		view_mtx = to_float4x4(view);
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "math_types.h"
+#include "simd_math.h"
+
+namespace end
+{
+	// Controls for one frame, in world units and radians
+	struct camera_input_t
+	{
+		float3 move = { 0.0f, 0.0f, 0.0f };	// x along the camera's right, y world up, z along the camera's forward
+		float yaw = 0.0f;						// positive turns right
+		float pitch = 0.0f;						// positive looks down
+	};
+
+	// Transform for cameras and other controlled objects, stored as position + yaw/pitch.
+	//
+	//	Input is accumulated with add_input() and applied in update(), which builds the
+	//	orientation from the angles, composes the world matrix once and caches its inverse
+	//	(the view matrix for MVP_t::view). Rebuilding from angles means there is no drift
+	//	and nothing to re-orthonormalize. Pitch stops just short of straight up/down.
+	class camera_t
+	{
+	public:
+
+		camera_t() { update(); }
+
+		void look_at(const float3& eye, const float3& target);
+		void set_position(const float3& p) { pos = p; }
+
+		// Replaces position and angles, drops pending input and updates
+		void set_pose(const float3& p, float yaw, float pitch);
+
+		void add_input(const camera_input_t& input);
+
+		// Applies the pending input and recomputes both matrices
+		void update();
+
+		// Camera to world (rows are right, up, forward, position)
+		const float4x4_a& world()const { return world_mtx; }
+
+		// World to camera, the inverse of world()
+		const float4x4_a& view()const { return view_mtx; }
+
+		float3 position()const { return pos; }
+		float yaw()const { return yaw_angle; }
+		float pitch()const { return pitch_angle; }
+		quat orientation()const;
+
+	private:
+
+		float3 pos = { 0.0f, 0.0f, 0.0f };
+		float yaw_angle = 0.0f;
+		float pitch_angle = 0.0f;
+
+		camera_input_t pending;
+
+		float4x4_a world_mtx;
+		float4x4_a view_mtx;
+	};
+}
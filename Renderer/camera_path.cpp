@@ -0,0 +1,152 @@
+#include "camera_path.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace end
+{
+	namespace
+	{
+		constexpr float DEGREES_TO_RADIANS = 3.1415926f / 180.0f;
+		constexpr float TWO_PI = 6.28318531f;
+
+		void set_error(std::string* error, const std::string& message)
+		{
+			if (error)
+				*error = message;
+		}
+
+		camera_pose_t lerp_pose(const camera_pose_t& a, const camera_pose_t& b, float t)
+		{
+			camera_pose_t out;
+			out.position.x = a.position.x + (b.position.x - a.position.x) * t;
+			out.position.y = a.position.y + (b.position.y - a.position.y) * t;
+			out.position.z = a.position.z + (b.position.z - a.position.z) * t;
+			out.yaw = a.yaw + std::remainder(b.yaw - a.yaw, TWO_PI) * t;
+			out.pitch = a.pitch + (b.pitch - a.pitch) * t;
+			return out;
+		}
+	}
+
+	bool camera_path_t::load(const char* path, std::string* error)
+	{
+		path_keys.clear();
+
+		FILE* file = fopen(path, "r");
+		if (!file)
+		{
+			set_error(error, std::string("can't open ") + path);
+			return false;
+		}
+
+		char line[512];
+		int line_number = 0;
+		bool ok = true;
+		while (ok && fgets(line, sizeof(line), file))
+		{
+			line_number++;
+
+			if (char* comment = strchr(line, '#'))
+				*comment = '\0';
+
+			camera_key_t key;
+			camera_pose_t& v = key.view;
+			camera_pose_t& f = key.frustum;
+			int fields = sscanf(line, "%f %f %f %f %f %f %f %f %f %f %f", &key.time,
+				&v.position.x, &v.position.y, &v.position.z, &v.yaw, &v.pitch,
+				&f.position.x, &f.position.y, &f.position.z, &f.yaw, &f.pitch);
+
+			// Blank or comment only
+			if (fields <= 0)
+				continue;
+
+			if (fields != 11)
+			{
+				set_error(error, std::string(path) + ":" + std::to_string(line_number) + ": expected 11 numbers");
+				ok = false;
+			}
+			else if (!path_keys.empty() && key.time < path_keys.back().time)
+			{
+				set_error(error, std::string(path) + ":" + std::to_string(line_number) + ": time goes back");
+				ok = false;
+			}
+			else
+			{
+				v.yaw *= DEGREES_TO_RADIANS;
+				v.pitch *= DEGREES_TO_RADIANS;
+				f.yaw *= DEGREES_TO_RADIANS;
+				f.pitch *= DEGREES_TO_RADIANS;
+				path_keys.push_back(key);
+			}
+		}
+		fclose(file);
+
+		if (ok && path_keys.empty())
+		{
+			set_error(error, std::string(path) + ": no keys");
+			ok = false;
+		}
+		if (!ok)
+			path_keys.clear();
+		return ok;
+	}
+
+	bool camera_path_t::save(const char* path, std::string* error)const
+	{
+		FILE* file = fopen(path, "w");
+		if (!file)
+		{
+			set_error(error, std::string("can't open ") + path);
+			return false;
+		}
+
+		const float to_degrees = 1.0f / DEGREES_TO_RADIANS;
+		bool ok = fprintf(file, "# time  view x y z yaw pitch  frustum x y z yaw pitch (degrees)\n") > 0;
+		for (const camera_key_t& k : path_keys)
+		{
+			const camera_pose_t& v = k.view;
+			const camera_pose_t& f = k.frustum;
+			ok = ok && fprintf(file, "%.6f  %.4f %.4f %.4f %.3f %.3f  %.4f %.4f %.4f %.3f %.3f\n", k.time,
+				v.position.x, v.position.y, v.position.z, v.yaw * to_degrees, v.pitch * to_degrees,
+				f.position.x, f.position.y, f.position.z, f.yaw * to_degrees, f.pitch * to_degrees) > 0;
+		}
+
+		if (fclose(file) != 0)
+			ok = false;
+		if (!ok)
+			set_error(error, std::string("write failed: ") + path);
+		return ok;
+	}
+
+	void camera_path_t::add(const camera_key_t& key)
+	{
+		if (!path_keys.empty() && key.time < path_keys.back().time)
+			return;
+		path_keys.push_back(key);
+	}
+
+	camera_key_t camera_path_t::sample(float time)const
+	{
+		if (path_keys.empty())
+			return {};
+		if (time <= path_keys.front().time)
+			return path_keys.front();
+		if (time >= path_keys.back().time)
+			return path_keys.back();
+
+		// First key after time, the one before it is at or before time
+		auto next = std::upper_bound(path_keys.begin(), path_keys.end(), time,
+			[](float t, const camera_key_t& k) { return t < k.time; });
+		const camera_key_t& a = *(next - 1);
+		const camera_key_t& b = *next;
+
+		float t = (time - a.time) / (b.time - a.time);
+		camera_key_t out;
+		out.time = time;
+		out.view = lerp_pose(a.view, b.view, t);
+		out.frustum = lerp_pose(a.frustum, b.frustum, t);
+		return out;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "math_types.h"
+
+namespace end
+{
+	// Where a camera_t is, angles in radians like camera_t::yaw()/pitch()
+	struct camera_pose_t
+	{
+		float3 position = { 0.0f, 0.0f, 0.0f };
+		float yaw = 0.0f;
+		float pitch = 0.0f;
+	};
+
+	// Both of the renderer's cameras at one time
+	struct camera_key_t
+	{
+		float time = 0.0f;		// seconds from the start of the path
+		camera_pose_t view;		// drives default_view
+		camera_pose_t frustum;	// the debug frustum that culling, occlusion and streaming use
+	};
+
+	// Keyframed camera flight for repeatable runs, recorded from the renderer (CAMERA_RECORD) or written by hand.
+	//
+	//	Text, one key per line, '#' starts a comment:
+	//		time  view_x view_y view_z view_yaw view_pitch  frustum_x frustum_y frustum_z frustum_yaw frustum_pitch
+	//	Angles in the file are degrees, times can't go back.
+	//	sample() interpolates linearly between the keys around a time (yaw the short way round)
+	//	and holds the first/last key outside the path.
+	class camera_path_t
+	{
+	public:
+
+		// false with a message in error if the file can't be read or a line doesn't parse
+		bool load(const char* path, std::string* error = nullptr);
+		bool save(const char* path, std::string* error = nullptr)const;
+
+		// Ignored if it is earlier than the last key
+		void add(const camera_key_t& key);
+		void clear() { path_keys.clear(); }
+
+		bool empty()const { return path_keys.empty(); }
+		size_t key_count()const { return path_keys.size(); }
+		float duration()const { return path_keys.empty() ? 0.0f : path_keys.back().time; }
+		const std::vector<camera_key_t>& keys()const { return path_keys; }
+
+		camera_key_t sample(float time)const;
+
+	private:
+
+		std::vector<camera_key_t> path_keys;
+	};
+}
@@ -0,0 +1,70 @@
+#include "cpu_features.h"
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace end
+{
+	namespace
+	{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+		void cpuid(uint32_t leaf, uint32_t out[4])
+		{
+#if defined(_MSC_VER)
+			__cpuidex((int*)out, (int)leaf, 0);
+#else
+			__cpuid_count(leaf, 0, out[0], out[1], out[2], out[3]);
+#endif
+		}
+
+		uint64_t xgetbv0()
+		{
+#if defined(_MSC_VER)
+			return _xgetbv(0);
+#else
+			uint32_t lo, hi;
+			__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+			return ((uint64_t)hi << 32) | lo;
+#endif
+		}
+
+		cpu_features_t detect()
+		{
+			cpu_features_t features;
+
+			uint32_t regs[4];
+			cpuid(0, regs);
+			uint32_t max_leaf = regs[0];
+
+			cpuid(1, regs);
+			features.sse41 = (regs[2] & (1u << 19)) != 0;
+
+			// AVX state has to be enabled by the OS too (OSXSAVE and the XMM/YMM bits of XCR0)
+			bool os_avx = (regs[2] & (1u << 27)) && (xgetbv0() & 0x6) == 0x6;
+			features.avx = os_avx && (regs[2] & (1u << 28));
+			features.fma = os_avx && (regs[2] & (1u << 12));
+
+			if (max_leaf >= 7)
+			{
+				cpuid(7, regs);
+				features.avx2 = os_avx && (regs[1] & (1u << 5));
+			}
+
+			return features;
+		}
+#else
+		cpu_features_t detect() { return {}; }
+#endif
+	}
+
+	const cpu_features_t& cpu_features()
+	{
+		static const cpu_features_t features = detect();
+		return features;
+	}
+}
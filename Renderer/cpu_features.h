@@ -0,0 +1,17 @@
+#pragma once
+
+namespace end
+{
+	// Instruction sets the CPU and OS support, for picking SIMD kernels at runtime.
+	// Kernels compiled for AVX2 must only run when avx2 and fma are both set.
+	struct cpu_features_t
+	{
+		bool sse41 = false;
+		bool avx = false;
+		bool avx2 = false;
+		bool fma = false;
+	};
+
+	// Detected once on first use
+	const cpu_features_t& cpu_features();
+}
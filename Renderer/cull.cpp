@@ -0,0 +1,190 @@
+#include "cull.h"
+
+#include <cmath>
+#include <cstring>
+#include <xmmintrin.h>
+
+#include "profiler.h"
+
+namespace end
+{
+	namespace
+	{
+		// Lanes of a 4 bit mask still being tested whose cached plane isn't p, the cached test already covered those
+		int count_tests(int live, const uint8_t* cached, int p)
+		{
+			int tests = 0;
+			for (int l = 0; l < 4; l++)
+			{
+				if ((live & (1 << l)) && (!cached || cached[l] != p))
+					tests++;
+			}
+			return tests;
+		}
+	}
+
+	size_t cull_aabbs(const aabb_soa_view_t& boxes, const plane_t planes[6], size_t first, size_t last, uint32_t* out,
+		uint8_t parent_inside, uint8_t* cull_planes, uint64_t* plane_tests)
+	{
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 sign_mask = _mm_set1_ps(-0.0f);
+
+		__m128 nx[6], ny[6], nz[6], ax[6], ay[6], az[6], d[6];
+		for (int p = 0; p < 6; p++)
+		{
+			nx[p] = _mm_set1_ps(planes[p].normal.x);
+			ny[p] = _mm_set1_ps(planes[p].normal.y);
+			nz[p] = _mm_set1_ps(planes[p].normal.z);
+			ax[p] = _mm_andnot_ps(sign_mask, nx[p]);
+			ay[p] = _mm_andnot_ps(sign_mask, ny[p]);
+			az[p] = _mm_andnot_ps(sign_mask, nz[p]);
+			d[p] = _mm_set1_ps(planes[p].offset);
+		}
+
+		size_t written = 0;
+		uint64_t tests = 0;
+		size_t i = first;
+
+		for (; i + 4 <= last; i += 4)
+		{
+			__m128 mnx = _mm_loadu_ps(boxes.min_x + i), mxx = _mm_loadu_ps(boxes.max_x + i);
+			__m128 mny = _mm_loadu_ps(boxes.min_y + i), mxy = _mm_loadu_ps(boxes.max_y + i);
+			__m128 mnz = _mm_loadu_ps(boxes.min_z + i), mxz = _mm_loadu_ps(boxes.max_z + i);
+
+			__m128 cx = _mm_mul_ps(_mm_add_ps(mnx, mxx), half), ex = _mm_mul_ps(_mm_sub_ps(mxx, mnx), half);
+			__m128 cy = _mm_mul_ps(_mm_add_ps(mny, mxy), half), ey = _mm_mul_ps(_mm_sub_ps(mxy, mny), half);
+			__m128 cz = _mm_mul_ps(_mm_add_ps(mnz, mxz), half), ez = _mm_mul_ps(_mm_sub_ps(mxz, mnz), half);
+
+			// Same test as AABBtoPlane: outside if (n.c - offset) < -(|n|.e)
+			auto outside_of = [&](__m128 px, __m128 py, __m128 pz, __m128 qx, __m128 qy, __m128 qz, __m128 pd)
+			{
+				__m128 dist = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, cx), _mm_mul_ps(py, cy)), _mm_mul_ps(pz, cz)), pd);
+				__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, ex), _mm_mul_ps(qy, ey)), _mm_mul_ps(qz, ez));
+				return _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(dist, radius), _mm_setzero_ps()));
+			};
+
+			int outside = 0;
+			uint8_t* cached = cull_planes ? cull_planes + i : nullptr;
+			if (cached)
+			{
+				// Each lane's last rejecting plane first, coherent frames reject most boxes here
+				const plane_t& p0 = planes[cached[0]];
+				const plane_t& p1 = planes[cached[1]];
+				const plane_t& p2 = planes[cached[2]];
+				const plane_t& p3 = planes[cached[3]];
+				__m128 px = _mm_setr_ps(p0.normal.x, p1.normal.x, p2.normal.x, p3.normal.x);
+				__m128 py = _mm_setr_ps(p0.normal.y, p1.normal.y, p2.normal.y, p3.normal.y);
+				__m128 pz = _mm_setr_ps(p0.normal.z, p1.normal.z, p2.normal.z, p3.normal.z);
+				__m128 pd = _mm_setr_ps(p0.offset, p1.offset, p2.offset, p3.offset);
+				outside = outside_of(px, py, pz, _mm_andnot_ps(sign_mask, px), _mm_andnot_ps(sign_mask, py), _mm_andnot_ps(sign_mask, pz), pd);
+				tests += 4;
+			}
+
+			for (int p = 0; p < 6 && outside != 0xF; p++)
+			{
+				if (parent_inside & (1 << p))
+					continue;
+
+				int live = ~outside & 0xF;
+				int rejected = outside_of(nx[p], ny[p], nz[p], ax[p], ay[p], az[p], d[p]) & live;
+				tests += count_tests(live, cached, p);
+
+				for (int l = 0; cached && l < 4; l++)
+				{
+					if (rejected & (1 << l))
+						cached[l] = (uint8_t)p;
+				}
+				outside |= rejected;
+			}
+
+			int pass = ~outside & 0xF;
+			for (int l = 0; l < 4; l++)
+			{
+				if (pass & (1 << l))
+					out[written++] = (uint32_t)(i + l);
+			}
+		}
+
+		for (; i < last; i++)
+		{
+			aabb_t box = boxes.get(i);
+			float3 c = box.center();
+			float3 e = box.extents();
+
+			// Cached plane, then the rest in order like AABBtoFrustum
+			int cached = cull_planes ? cull_planes[i] : 0;
+			bool inside = true;
+			for (int n = cull_planes ? 0 : 1; n < 7 && inside; n++)
+			{
+				int p = n == 0 ? cached : n - 1;
+				if ((cull_planes && n > 0 && p == cached) || (parent_inside & (1 << p)))
+					continue;
+
+				const float3& normal = planes[p].normal;
+				float dist = dot(normal, c) - planes[p].offset;
+				float radius = e.x * std::fabs(normal.x) + e.y * std::fabs(normal.y) + e.z * std::fabs(normal.z);
+				inside = dist >= -radius;
+				tests++;
+
+				if (!inside && cull_planes)
+					cull_planes[i] = (uint8_t)p;
+			}
+
+			if (inside)
+				out[written++] = (uint32_t)i;
+		}
+
+		if (plane_tests)
+			*plane_tests += tests;
+		return written;
+	}
+
+	void frustum_culler_t::cull(const aabb_soa_view_t& boxes, const plane_t planes[6], job_system_t& jobs, std::vector<uint32_t>& visible,
+		uint8_t parent_inside, frustum_cull_stats_t* stats)
+	{
+		const size_t count = boxes.count;
+		const size_t chunk_count = (count + CULL_CHUNK_SIZE - 1) / CULL_CHUNK_SIZE;
+
+		scratch.resize(count);
+		chunk_counts.resize(chunk_count);
+		chunk_offsets.resize(chunk_count);
+		chunk_tests.assign(chunk_count, 0);
+
+		// A different box set, the cached planes belong to the old one
+		if (cull_planes.size() != count)
+			cull_planes.assign(count, 0);
+
+		// Cull, each chunk owns scratch[first, last), cull_planes[first, last) and its test count
+		jobs.parallel_for(count, CULL_CHUNK_SIZE, [&](size_t first, size_t last)
+		{
+			PROFILE_SCOPE("cull chunk");
+			size_t c = first / CULL_CHUNK_SIZE;
+			chunk_counts[c] = (uint32_t)cull_aabbs(boxes, planes, first, last, scratch.data() + first,
+				parent_inside, cull_planes.data(), &chunk_tests[c]);
+		});
+
+		size_t total = 0;
+		for (size_t c = 0; c < chunk_count; c++)
+		{
+			chunk_offsets[c] = total;
+			total += chunk_counts[c];
+		}
+
+		if (stats)
+		{
+			stats->objects += count;
+			for (uint64_t tests : chunk_tests)
+				stats->plane_tests += tests;
+		}
+
+		visible.resize(total);
+
+		// Pack, each chunk owns visible[offset, offset + count)
+		jobs.parallel_for(count, CULL_CHUNK_SIZE, [&](size_t first, size_t)
+		{
+			size_t c = first / CULL_CHUNK_SIZE;
+			if (chunk_counts[c])
+				std::memcpy(visible.data() + chunk_offsets[c], scratch.data() + first, chunk_counts[c] * sizeof(uint32_t));
+		});
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "bounds.h"
+#include "job_system.h"
+
+namespace end
+{
+	// Frustum plane with the normal pointing into the frustum,
+	// points with dot(normal, p) >= offset are on the inside.
+	struct plane_t
+	{
+		float3 normal;
+		float offset;
+	};
+
+	// Counts plane tests so the savings of the plane cache can be measured on a camera path
+	struct frustum_cull_stats_t
+	{
+		uint64_t objects = 0;
+		uint64_t plane_tests = 0;
+
+		double average_plane_tests()const { return objects ? double(plane_tests) / double(objects) : 0.0; }
+		void reset() { objects = plane_tests = 0; }
+	};
+
+	// Boxes per chunk handed to the job system
+	constexpr size_t CULL_CHUNK_SIZE = 4096;
+
+	// Tests boxes [first, last) against 6 planes, 4 at a time with SSE.
+	// Appends the indices of boxes not fully outside any plane to out (room for last - first)
+	// in increasing order and returns how many were written.
+	// parent_inside: planes a box enclosing all of them is fully inside of (bit i = plane i), skipped.
+	// cull_planes (optional, indexed like boxes): the plane that rejected each box last time,
+	// tested first and updated on rejection. plane_tests (optional) is increased by the tests done per box.
+	size_t cull_aabbs(const aabb_soa_view_t& boxes, const plane_t planes[6], size_t first, size_t last, uint32_t* out,
+		uint8_t parent_inside = 0, uint8_t* cull_planes = nullptr, uint64_t* plane_tests = nullptr);
+
+	// Parallel frustum culling over fixed size chunks.
+	//
+	//	Every chunk writes its survivors into its own slice of a scratch buffer,
+	//	then the slices are packed into the visible list at offsets from a prefix sum.
+	//	No locks or atomics on the results, and the visible list is always in index order
+	//	no matter how chunks were scheduled, so frames are reproducible.
+	//	Keeps the rejecting plane of every box between calls, it starts over when the box count changes.
+	class frustum_culler_t
+	{
+	public:
+
+		// visible is resized to the number of boxes that passed, stats (optional) counts boxes and plane tests
+		void cull(const aabb_soa_view_t& boxes, const plane_t planes[6], job_system_t& jobs, std::vector<uint32_t>& visible,
+			uint8_t parent_inside = 0, frustum_cull_stats_t* stats = nullptr);
+
+	private:
+
+		std::vector<uint32_t> scratch;
+		std::vector<uint32_t> chunk_counts;
+		std::vector<size_t> chunk_offsets;
+		std::vector<uint64_t> chunk_tests;
+		std::vector<uint8_t> cull_planes;
+	};
+}
@@ -0,0 +1,435 @@
+#include "renderer.h"
+
+#ifdef FSGD_END_USE_D3D
+
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+// DIRECT X STUFF
+#include <dxgi1_2.h>
+#include <d3d11_2.h>
+
+#pragma comment(lib, "d2d1.lib")
+#pragma comment(lib, "d3d11.lib")
+#pragma comment(lib, "DXGI.lib")
+
+#include <cassert>
+
+#include "asset_loader.h"
+#include "debug_renderer.h"
+#include "render_backend.h"
+
+namespace
+{
+	template<typename T>
+	void safe_release(T* t)
+	{
+		if (t)
+			t->Release();
+	}
+}
+
+namespace end
+{
+	class d3d11_backend_t final : public render_backend_t
+	{
+	public:
+
+		explicit d3d11_backend_t(HWND window) : hwnd(window) {}
+
+		~d3d11_backend_t() override
+		{
+			// In general, release objects in reverse order of creation
+			for (auto& ptr : constant_buffer)
+				safe_release(ptr);
+
+			for (auto& ptr : pixel_shader)
+				safe_release(ptr);
+
+			for (auto& ptr : vertex_shader)
+				safe_release(ptr);
+
+			for (auto& ptr : input_layout)
+				safe_release(ptr);
+
+			for (auto& ptr : index_buffer)
+				safe_release(ptr);
+
+			for (auto& ptr : vertex_buffer)
+				safe_release(ptr);
+
+			for (auto& ptr : rasterState)
+				safe_release(ptr);
+
+			for (auto& ptr : depthStencilState)
+				safe_release(ptr);
+
+			for (auto& ptr : depthStencilView)
+				safe_release(ptr);
+
+			for (auto& ptr : render_target)
+				safe_release(ptr);
+
+			safe_release(context);
+			safe_release(swapchain);
+			safe_release(device);
+		}
+
+		void initialize(asset_loader_t& assets, job_system_t&) override
+		{
+			// Shader files are read while the device and swapchain get set up
+			request_shaders(assets);
+
+			create_device_and_swapchain();
+
+			create_main_render_target();
+
+			setup_depth_stencil();
+
+			setup_rasterizer();
+
+			create_constant_buffers();
+		}
+
+		float width()const override { return view_port[VIEWPORT::DEFAULT].Width; }
+		float height()const override { return view_port[VIEWPORT::DEFAULT].Height; }
+
+		void begin_frame(const float4& clear_color) override
+		{
+			context->OMSetDepthStencilState(depthStencilState[STATE_DEPTH_STENCIL::DEFAULT], 1);
+			context->OMSetRenderTargets(1, &render_target[VIEW_RENDER_TARGET::DEFAULT], depthStencilView[VIEW_DEPTH_STENCIL::DEFAULT]);
+
+			context->ClearRenderTargetView(render_target[VIEW_RENDER_TARGET::DEFAULT], clear_color.data());
+			context->ClearDepthStencilView(depthStencilView[VIEW_DEPTH_STENCIL::DEFAULT], D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+
+			context->RSSetState(rasterState[STATE_RASTERIZER::DEFAULT]);
+			context->RSSetViewports(1, &view_port[VIEWPORT::DEFAULT]);
+
+			context->VSSetConstantBuffers(0, 1, &constant_buffer[CONSTANT_BUFFER::MVP]);
+		}
+
+		void update_mvp(const MVP_t& mvp) override
+		{
+			context->UpdateSubresource(constant_buffer[CONSTANT_BUFFER::MVP], 0, nullptr, &mvp, 0, 0);
+		}
+
+		void draw_cube() override
+		{
+			context->IASetInputLayout(input_layout[INPUT_LAYOUT::BUFFERLESS_CUBE]);
+			context->VSSetShader(vertex_shader[VERTEX_SHADER::BUFFERLESS_CUBE], nullptr, 0);
+			context->PSSetShader(pixel_shader[PIXEL_SHADER::BUFFERLESS_CUBE], nullptr, 0);
+
+			context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+			context->Draw(36, 0);
+		}
+
+		void draw_lines(const colored_vertex* verts, size_t vert_count) override
+		{
+			size_t capacity = end::debug_renderer::get_line_vert_capacity();
+			if (vert_count > capacity)
+				vert_count = capacity;
+			if (vert_count == 0)
+				return;
+
+			context->IASetInputLayout(input_layout[INPUT_LAYOUT::COLORED_VERTEX]);
+			context->VSSetShader(vertex_shader[VERTEX_SHADER::COLORED_VERTEX], nullptr, 0);
+			context->PSSetShader(pixel_shader[PIXEL_SHADER::COLORED_VERTEX], nullptr, 0);
+
+			context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
+
+			// Only the used part of the buffer
+			D3D11_BOX used = { 0u, 0u, 0u, (UINT)(vert_count * sizeof(colored_vertex)), 1u, 1u };
+			context->UpdateSubresource(vertex_buffer[VERTEX_BUFFER::COLORED_VERTEX], 0, &used, verts, 0, 0);
+
+			const UINT strides = sizeof(colored_vertex);
+			const UINT offset = 0u;
+			context->IASetVertexBuffers(0u, 1u, &vertex_buffer[VERTEX_BUFFER::COLORED_VERTEX], &strides, &offset);
+
+			context->Draw((UINT)vert_count, 0u);
+		}
+
+		void present() override
+		{
+			swapchain->Present(1u, 0u);
+		}
+
+	private:
+
+#pragma region POINTERS
+		HWND hwnd;
+
+		ID3D11Device* device = nullptr;
+		ID3D11DeviceContext* context = nullptr;
+		IDXGISwapChain* swapchain = nullptr;
+
+		ID3D11RenderTargetView* render_target[VIEW_RENDER_TARGET::COUNT]{};
+
+		ID3D11DepthStencilView* depthStencilView[VIEW_DEPTH_STENCIL::COUNT]{};
+
+		ID3D11DepthStencilState* depthStencilState[STATE_DEPTH_STENCIL::COUNT]{};
+
+		ID3D11RasterizerState* rasterState[STATE_RASTERIZER::COUNT]{};
+
+		ID3D11Buffer* vertex_buffer[VERTEX_BUFFER::COUNT]{};
+
+		ID3D11Buffer* index_buffer[INDEX_BUFFER::COUNT]{};
+
+		ID3D11InputLayout* input_layout[INPUT_LAYOUT::COUNT]{};
+
+		ID3D11VertexShader* vertex_shader[VERTEX_SHADER::COUNT]{};
+
+		ID3D11PixelShader* pixel_shader[PIXEL_SHADER::COUNT]{};
+
+		ID3D11Buffer* constant_buffer[CONSTANT_BUFFER::COUNT]{};
+
+		D3D11_VIEWPORT				view_port[VIEWPORT::COUNT]{};
+
+		/* Add more as needed...
+		ID3D11SamplerState*			sampler_state[STATE_SAMPLER::COUNT]{};
+
+		ID3D11BlendState*			blend_state[STATE_BLEND::COUNT]{};
+		*/
+#pragma endregion
+
+		void create_device_and_swapchain()
+		{
+			RECT crect;
+			GetClientRect(hwnd, &crect);
+
+			// Setup the viewport
+			D3D11_VIEWPORT& vp = view_port[VIEWPORT::DEFAULT];
+
+			vp.Width = (float)crect.right;
+			vp.Height = (float)crect.bottom;
+			vp.MinDepth = 0.0f;
+			vp.MaxDepth = 1.0f;
+			vp.TopLeftX = 0;
+			vp.TopLeftY = 0;
+
+			// Setup swapchain
+			DXGI_SWAP_CHAIN_DESC sd;
+			ZeroMemory(&sd, sizeof(sd));
+			sd.BufferCount = 2;
+			sd.BufferDesc.Width = crect.right;
+			sd.BufferDesc.Height = crect.bottom;
+			sd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+			sd.BufferDesc.RefreshRate.Numerator = 60;
+			sd.BufferDesc.RefreshRate.Denominator = 1;
+			sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+			sd.OutputWindow = hwnd;
+			sd.SampleDesc.Count = 1;
+			sd.SampleDesc.Quality = 0;
+			sd.Windowed = TRUE;
+			sd.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+
+			D3D_FEATURE_LEVEL  FeatureLevelsSupported;
+
+			const D3D_FEATURE_LEVEL lvl[] =
+			{
+				D3D_FEATURE_LEVEL_11_1, D3D_FEATURE_LEVEL_11_0,
+				D3D_FEATURE_LEVEL_10_1, D3D_FEATURE_LEVEL_10_0,
+				D3D_FEATURE_LEVEL_9_3, D3D_FEATURE_LEVEL_9_2, D3D_FEATURE_LEVEL_9_1
+			};
+
+			UINT createDeviceFlags = 0;
+
+#ifdef _DEBUG
+			createDeviceFlags |= D3D11_CREATE_DEVICE_DEBUG;
+#endif
+
+			HRESULT hr = D3D11CreateDeviceAndSwapChain(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, createDeviceFlags, lvl, _countof(lvl), D3D11_SDK_VERSION, &sd, &swapchain, &device, &FeatureLevelsSupported, &context);
+
+			if (hr == E_INVALIDARG)
+			{
+				hr = D3D11CreateDeviceAndSwapChain(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, createDeviceFlags, &lvl[1], _countof(lvl) - 1, D3D11_SDK_VERSION, &sd, &swapchain, &device, &FeatureLevelsSupported, &context);
+			}
+
+			assert(!FAILED(hr));
+		}
+
+		void create_main_render_target()
+		{
+			ID3D11Texture2D* pBackBuffer;
+			// Get a pointer to the back buffer
+			HRESULT hr = swapchain->GetBuffer(0, __uuidof(ID3D11Texture2D),
+				(LPVOID*)& pBackBuffer);
+
+			assert(!FAILED(hr));
+
+			// Create a render-target view
+			device->CreateRenderTargetView(pBackBuffer, NULL,
+				&render_target[VIEW_RENDER_TARGET::DEFAULT]);
+
+			pBackBuffer->Release();
+		}
+
+		void setup_depth_stencil()
+		{
+			/* DEPTH_BUFFER */
+			D3D11_TEXTURE2D_DESC depthBufferDesc;
+			ID3D11Texture2D* depthStencilBuffer;
+
+			ZeroMemory(&depthBufferDesc, sizeof(depthBufferDesc));
+
+			depthBufferDesc.Width = (UINT)view_port[VIEWPORT::DEFAULT].Width;
+			depthBufferDesc.Height = (UINT)view_port[VIEWPORT::DEFAULT].Height;
+			depthBufferDesc.MipLevels = 1;
+			depthBufferDesc.ArraySize = 1;
+			depthBufferDesc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
+			depthBufferDesc.SampleDesc.Count = 1;
+			depthBufferDesc.SampleDesc.Quality = 0;
+			depthBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+			depthBufferDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+			depthBufferDesc.CPUAccessFlags = 0;
+			depthBufferDesc.MiscFlags = 0;
+
+			HRESULT hr = device->CreateTexture2D(&depthBufferDesc, NULL, &depthStencilBuffer);
+
+			assert(!FAILED(hr));
+
+			/* DEPTH_STENCIL */
+			D3D11_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc;
+
+			ZeroMemory(&depthStencilViewDesc, sizeof(depthStencilViewDesc));
+
+			depthStencilViewDesc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
+			depthStencilViewDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+			depthStencilViewDesc.Texture2D.MipSlice = 0;
+
+			hr = device->CreateDepthStencilView(depthStencilBuffer, &depthStencilViewDesc, &depthStencilView[VIEW_DEPTH_STENCIL::DEFAULT]);
+
+			assert(!FAILED(hr));
+
+			depthStencilBuffer->Release();
+
+			/* DEPTH_STENCIL_DESC */
+			D3D11_DEPTH_STENCIL_DESC depthStencilDesc;
+
+			ZeroMemory(&depthStencilDesc, sizeof(depthStencilDesc));
+
+			depthStencilDesc.DepthEnable = true;
+			depthStencilDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+			depthStencilDesc.DepthFunc = D3D11_COMPARISON_LESS_EQUAL;
+
+			hr = device->CreateDepthStencilState(&depthStencilDesc, &depthStencilState[STATE_DEPTH_STENCIL::DEFAULT]);
+
+			assert(!FAILED(hr));
+		}
+
+		void setup_rasterizer()
+		{
+			D3D11_RASTERIZER_DESC rasterDesc;
+
+			ZeroMemory(&rasterDesc, sizeof(rasterDesc));
+
+			rasterDesc.AntialiasedLineEnable = true;
+			rasterDesc.CullMode = D3D11_CULL_BACK;
+			rasterDesc.DepthBias = 0;
+			rasterDesc.DepthBiasClamp = 0.0f;
+			rasterDesc.DepthClipEnable = false;
+			rasterDesc.FillMode = D3D11_FILL_SOLID;
+			rasterDesc.FrontCounterClockwise = false;
+			rasterDesc.MultisampleEnable = false;
+			rasterDesc.ScissorEnable = false;
+			rasterDesc.SlopeScaledDepthBias = 0.0f;
+
+			HRESULT hr = device->CreateRasterizerState(&rasterDesc, &rasterState[STATE_RASTERIZER::DEFAULT]);
+
+			assert(!FAILED(hr));
+		}
+
+		// Queues the shader files, the callbacks run once the device exists (see initialize)
+		void request_shaders(asset_loader_t& assets)
+		{
+			//////// CUBE SHADERS ////////
+			assets.load("vs_cube.cso", [this, &assets](asset_handle_t handle, const blob_view_t& blob)
+			{
+				HRESULT hr = device->CreateVertexShader(blob.data(), blob.size(), NULL, &vertex_shader[VERTEX_SHADER::BUFFERLESS_CUBE]);
+
+				assert(!FAILED(hr));
+
+				const D3D11_INPUT_ELEMENT_DESC inputDesc[] =
+				{
+					{"SV_VertexID",0,DXGI_FORMAT_R32_UINT,0,D3D11_APPEND_ALIGNED_ELEMENT,D3D11_INPUT_PER_VERTEX_DATA,0},
+				};
+				hr = device->CreateInputLayout(inputDesc, 1, blob.data(), blob.size(), &input_layout[INPUT_LAYOUT::BUFFERLESS_CUBE]);
+
+				assert(!FAILED(hr));
+				assets.release(handle);
+			});
+
+			assets.load("ps_cube.cso", [this, &assets](asset_handle_t handle, const blob_view_t& blob)
+			{
+				HRESULT hr = device->CreatePixelShader(blob.data(), blob.size(), NULL, &pixel_shader[PIXEL_SHADER::BUFFERLESS_CUBE]);
+
+				assert(!FAILED(hr));
+				assets.release(handle);
+			});
+			///
+
+			/////// DEBUG LINES SHADERS ///////
+			assets.load("debug_line_vs.cso", [this, &assets](asset_handle_t handle, const blob_view_t& blob)
+			{
+				HRESULT hr = device->CreateVertexShader(blob.data(), blob.size(), NULL, &vertex_shader[VERTEX_SHADER::COLORED_VERTEX]);
+
+				assert(!FAILED(hr));
+
+				const D3D11_INPUT_ELEMENT_DESC debug_inputDesc[] =
+				{
+					{"Position",0,DXGI_FORMAT_R32G32B32A32_FLOAT,0,D3D11_APPEND_ALIGNED_ELEMENT,D3D11_INPUT_PER_VERTEX_DATA,0},
+					{"Color",0,DXGI_FORMAT_R32G32B32A32_FLOAT,0,D3D11_APPEND_ALIGNED_ELEMENT,D3D11_INPUT_PER_VERTEX_DATA,0}
+				};
+				hr = device->CreateInputLayout(debug_inputDesc, 2, blob.data(), blob.size(), &input_layout[INPUT_LAYOUT::COLORED_VERTEX]);
+
+				assert(!FAILED(hr));
+				assets.release(handle);
+			});
+
+			assets.load("debug_line_ps.cso", [this, &assets](asset_handle_t handle, const blob_view_t& blob)
+			{
+				HRESULT hr = device->CreatePixelShader(blob.data(), blob.size(), NULL, &pixel_shader[PIXEL_SHADER::COLORED_VERTEX]);
+
+				assert(!FAILED(hr));
+				assets.release(handle);
+			});
+			///
+		}
+
+		void create_constant_buffers()
+		{
+			D3D11_BUFFER_DESC mvp_bd;
+			ZeroMemory(&mvp_bd, sizeof(mvp_bd));
+
+			mvp_bd.Usage = D3D11_USAGE_DEFAULT;
+			mvp_bd.ByteWidth = sizeof(MVP_t);
+			mvp_bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+			mvp_bd.CPUAccessFlags = 0;
+
+			HRESULT hr = device->CreateBuffer(&mvp_bd, NULL, &constant_buffer[CONSTANT_BUFFER::MVP]);
+
+			assert(!FAILED(hr));
+
+			// Create Vertex Buffer for Debug Lines
+			D3D11_BUFFER_DESC vbDes;
+			vbDes.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+			vbDes.Usage = D3D11_USAGE_DEFAULT;
+			vbDes.CPUAccessFlags = 0u;
+			vbDes.MiscFlags = 0u;
+			vbDes.ByteWidth = sizeof(colored_vertex) * (UINT)end::debug_renderer::get_line_vert_capacity();
+			vbDes.StructureByteStride = sizeof(colored_vertex);
+			D3D11_SUBRESOURCE_DATA subData = {};
+			subData.pSysMem = end::debug_renderer::get_line_verts();
+
+			hr = device->CreateBuffer(&vbDes, &subData, &vertex_buffer[VERTEX_BUFFER::COLORED_VERTEX]);
+
+			assert(!FAILED(hr));
+		}
+	};
+
+	std::unique_ptr<render_backend_t> create_d3d11_backend(void* window)
+	{
+		return std::unique_ptr<render_backend_t>(new d3d11_backend_t((HWND)window));
+	}
+}
+#endif
@@ -20,7 +20,7 @@ namespace end
 {
 	namespace debug_renderer
 	{
-		void end::debug_renderer::add_line(float3 point_a, float3 point_b, float4 color_a, float4 color_b)
+		void add_line(float3 point_a, float3 point_b, float4 color_a, float4 color_b)
 		{
 			// Add points to debug_verts, increments debug_vert_count
 			if (line_vert_count < MAX_LINE_VERTS)
@@ -59,34 +59,17 @@ namespace end
 			}
 		}
 
-		void add_line(XMVECTOR point_a, XMVECTOR point_b, XMVECTOR color_a, XMVECTOR color_b)
+		void add_lines(const float3* points, size_t point_count, float4 color)
 		{
-			// Add points to debug_verts, increments debug_vert_count
-			if (line_vert_count < MAX_LINE_VERTS)
-			{
-				// FROM POINT A
-				line_verts[line_vert_count].pos.x = point_a.m128_f32[0];
-				line_verts[line_vert_count].pos.y = point_a.m128_f32[1];
-				line_verts[line_vert_count].pos.z = point_a.m128_f32[2];
-				line_verts[line_vert_count].pos.w = point_a.m128_f32[3];
-
-				line_verts[line_vert_count].color.x = color_a.m128_f32[0];
-				line_verts[line_vert_count].color.y = color_a.m128_f32[1];
-				line_verts[line_vert_count].color.z = color_a.m128_f32[2];
-				line_verts[line_vert_count].color.w = color_a.m128_f32[3];
+			// Whole lines only, the rest is dropped when the buffer is full
+			size_t count = point_count & ~(size_t)1;
+			if (count > MAX_LINE_VERTS - line_vert_count)
+				count = (MAX_LINE_VERTS - line_vert_count) & ~(size_t)1;
 
-				line_vert_count++;
-
-				// TO POINT B
-				line_verts[line_vert_count].pos.x = point_b.m128_f32[0];
-				line_verts[line_vert_count].pos.y = point_b.m128_f32[1];
-				line_verts[line_vert_count].pos.z = point_b.m128_f32[2];
-				line_verts[line_vert_count].pos.w = point_b.m128_f32[3];
-
-				line_verts[line_vert_count].color.x = color_b.m128_f32[0];
-				line_verts[line_vert_count].color.y = color_b.m128_f32[1];
-				line_verts[line_vert_count].color.z = color_b.m128_f32[2];
-				line_verts[line_vert_count].color.w = color_b.m128_f32[3];
+			for (size_t i = 0; i < count; i++)
+			{
+				line_verts[line_vert_count].pos = { points[i].x, points[i].y, points[i].z, 1.0f };
+				line_verts[line_vert_count].color = color;
 				line_vert_count++;
 			}
 		}
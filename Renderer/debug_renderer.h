@@ -7,14 +7,17 @@ namespace end
 {
 	namespace debug_renderer
 	{
-		using namespace DirectX;
 		void add_line(float3 point_a, float3 point_b, float4 color_a, float4 color_b);
 		void add_line(float4 point_a, float4 point_b, float4 color_a, float4 color_b);
-		void add_line(XMVECTOR point_a, XMVECTOR point_b, XMVECTOR color_a, XMVECTOR color_b);
 
 		inline void add_line(float3 p, float3 q, float4 color) { add_line(p, q, color, color); }
 		inline void add_line(float4 p, float4 q, float4 color) { add_line(p, q, color, color); }
-		inline void add_line(XMVECTOR p, XMVECTOR q, XMVECTOR color) { add_line(p, q, color, color); }
+
+		// Point pairs in one color, e.g. the line lists from geometry.h
+		void add_lines(const float3* points, size_t point_count, float4 color);
+
+		template<size_t N>
+		inline void add_lines(const std::array<float3, N>& points, float4 color) { add_lines(points.data(), N, color); }
 
 		void clear_lines();
 
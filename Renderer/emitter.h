@@ -11,6 +11,8 @@
 #define RED			{ 1.0f,0.0f,0.0f,1.0f }
 #define GREEN		{ 0.0f,1.0f,0.0f,1.0f }
 #define BLUE		{ 0.0f,0.0f,1.0f,1.0f }
+#define GREY		{ 0.5f,0.5f,0.5f,1.0f }
+#define YELLOW		{ 1.0f,1.0f,0.0f,1.0f }
 
 struct Particle
 {
@@ -0,0 +1,134 @@
+#include "frame_limiter.h"
+
+#include <algorithm>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#elif defined(__linux__)
+#include <cerrno>
+#include <time.h>
+#else
+#include <thread>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>
+#define END_SPIN_PAUSE() _mm_pause()
+#else
+#define END_SPIN_PAUSE() ((void)0)
+#endif
+
+namespace end
+{
+	namespace
+	{
+		constexpr auto INITIAL_MARGIN = std::chrono::microseconds(1000);
+		constexpr auto MIN_MARGIN = std::chrono::microseconds(50);
+		constexpr auto MAX_MARGIN = std::chrono::microseconds(20000);
+	}
+
+	frame_limiter_t::frame_limiter_t(double target_hz)
+	{
+#if defined(_WIN32)
+		timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+		// Older than Windows 10 1803, the plain timer still beats Sleep's whole milliseconds
+		if (!timer)
+			timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+#endif
+		margin = std::chrono::duration_cast<clock::duration>(INITIAL_MARGIN);
+		set_target_hz(target_hz);
+		reset();
+	}
+
+	frame_limiter_t::~frame_limiter_t()
+	{
+#if defined(_WIN32)
+		if (timer)
+			CloseHandle(timer);
+#endif
+	}
+
+	void frame_limiter_t::set_target_hz(double target_hz)
+	{
+		hz = target_hz > 0.0 ? target_hz : 60.0;
+		period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / hz));
+	}
+
+	void frame_limiter_t::reset()
+	{
+		deadline = clock::now() + period;
+		error = 0.0;
+	}
+
+	double frame_limiter_t::wait()
+	{
+		clock::time_point start = clock::now();
+
+		// More than a frame behind, start over instead of running frames back to back
+		if (start > deadline + period)
+			deadline = start;
+
+		clock::time_point sleep_target = deadline - margin;
+		if (start < sleep_target)
+		{
+			sleep_until(sleep_target);
+
+			// Keep the margin a bit above the recent worst oversleep, decaying slowly
+			clock::duration late = clock::now() - sleep_target;
+			clock::duration wanted = late + late / 2;
+			margin = std::max(wanted, margin - margin / 64);
+			margin = std::min(std::max(margin, std::chrono::duration_cast<clock::duration>(MIN_MARGIN)),
+				std::chrono::duration_cast<clock::duration>(MAX_MARGIN));
+		}
+
+		clock::time_point now = clock::now();
+		while (now < deadline)
+		{
+			END_SPIN_PAUSE();
+			now = clock::now();
+		}
+
+		error = std::chrono::duration<double>(now - deadline).count();
+		deadline += period;
+		return std::chrono::duration<double>(now - start).count();
+	}
+
+	void frame_limiter_t::sleep_until(clock::time_point until)
+	{
+#if defined(_WIN32)
+		clock::duration remaining = until - clock::now();
+		if (remaining <= clock::duration::zero())
+			return;
+
+		if (timer)
+		{
+			// Relative due time in 100 ns units
+			LARGE_INTEGER due;
+			due.QuadPart = -(LONGLONG)std::max<long long>(1, std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count() / 100);
+			if (SetWaitableTimerEx(timer, &due, 0, nullptr, nullptr, nullptr, 0))
+			{
+				WaitForSingleObject(timer, INFINITE);
+				return;
+			}
+		}
+		Sleep((DWORD)std::chrono::duration_cast<std::chrono::milliseconds>(remaining).count());
+#elif defined(__linux__)
+		// steady_clock is CLOCK_MONOTONIC, an absolute wake time can't add up drift
+		auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(until.time_since_epoch()).count();
+		timespec ts;
+		ts.tv_sec = (time_t)(ns / 1000000000);
+		ts.tv_nsec = (long)(ns % 1000000000);
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+		{
+		}
+#else
+		std::this_thread::sleep_until(until);
+#endif
+	}
+}
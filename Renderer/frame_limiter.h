@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+
+namespace end
+{
+	// Holds a loop to a fixed frame rate.
+	//
+	//	wait() sleeps with the OS's finest timer (high resolution waitable timer on Windows,
+	//	absolute clock_nanosleep elsewhere) until spin_margin before the deadline, then spins the rest.
+	//	The margin follows how late the sleeps actually wake up, so it shrinks on good schedulers
+	//	and grows on coarse ones. Deadlines advance by whole frame periods from the previous deadline,
+	//	so a late frame is paid back by the next one instead of drifting; a loop more than a frame
+	//	behind is restarted from now rather than rushing to catch up.
+	class frame_limiter_t
+	{
+	public:
+
+		using clock = std::chrono::steady_clock;
+
+		explicit frame_limiter_t(double target_hz = 60.0);
+		~frame_limiter_t();
+
+		frame_limiter_t(const frame_limiter_t&) = delete;
+		frame_limiter_t& operator=(const frame_limiter_t&) = delete;
+
+		// Takes effect from the next deadline
+		void set_target_hz(double hz);
+		double target_hz()const { return hz; }
+
+		// Next deadline is one period from now
+		void reset();
+
+		// Blocks until the current deadline and moves it on a period, returns the seconds spent waiting
+		double wait();
+
+		// How late the last wait returned after its deadline, in seconds
+		double last_error()const { return error; }
+
+		// Time before a deadline left to spinning, in seconds
+		double spin_margin()const { return std::chrono::duration<double>(margin).count(); }
+
+	private:
+
+		// Sleeps until about until, never past it on purpose
+		void sleep_until(clock::time_point until);
+
+		double hz = 60.0;
+		clock::duration period{};
+		clock::time_point deadline{};
+		clock::duration margin{};
+		double error = 0.0;
+		void* timer = nullptr; // Windows waitable timer
+	};
+}
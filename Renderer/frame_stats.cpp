@@ -0,0 +1,190 @@
+#include "frame_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace end
+{
+	size_t histogram_t::bucket_of(uint64_t us)
+	{
+		if (us < SUB_COUNT)
+			return (size_t)us;
+
+		us = std::min<uint64_t>(us, (1ull << MAX_BITS) - 1);
+
+		int msb = 63;
+		while (!(us >> msb))
+			msb--;
+
+		// Top SUB_BITS bits of the value pick the bucket within its power of two
+		int shift = msb - (SUB_BITS - 1);
+		return (size_t)shift * (SUB_COUNT / 2) + (size_t)(us >> shift);
+	}
+
+	uint64_t histogram_t::bucket_high(size_t bucket)
+	{
+		if (bucket < SUB_COUNT)
+			return bucket;
+
+		size_t shift = bucket / (SUB_COUNT / 2) - 1;
+		uint64_t sub = bucket - shift * (SUB_COUNT / 2);
+		return ((sub + 1) << shift) - 1;
+	}
+
+	void histogram_t::record(double seconds)
+	{
+		uint64_t us = seconds > 0.0 ? (uint64_t)std::llround(seconds * 1e6) : 0;
+		counts[bucket_of(us)]++;
+		total++;
+		sum_us += (double)us;
+		max_us = std::max(max_us, us);
+	}
+
+	void histogram_t::merge(const histogram_t& other)
+	{
+		for (size_t i = 0; i < BUCKET_COUNT; i++)
+			counts[i] += other.counts[i];
+		total += other.total;
+		sum_us += other.sum_us;
+		max_us = std::max(max_us, other.max_us);
+	}
+
+	void histogram_t::reset()
+	{
+		counts.fill(0);
+		total = 0;
+		sum_us = 0.0;
+		max_us = 0;
+	}
+
+	double histogram_t::percentile(double p)const
+	{
+		if (total == 0)
+			return 0.0;
+
+		p = std::min(std::max(p, 0.0), 100.0);
+		uint64_t rank = std::max<uint64_t>(1, (uint64_t)std::ceil(p * 0.01 * (double)total));
+
+		uint64_t seen = 0;
+		for (size_t i = 0; i < BUCKET_COUNT; i++)
+		{
+			seen += counts[i];
+			if (seen >= rank)
+				return (double)std::min(bucket_high(i), max_us) * 1e-6;
+		}
+		return max();
+	}
+
+	frame_stats_t::frame_stats_t(double hitch_threshold, double interval, size_t interval_count)
+		: interval(interval > 0.0 ? interval : 1.0), interval_count(std::max<size_t>(1, interval_count))
+	{
+		add_series("frame", hitch_threshold);
+	}
+
+	size_t frame_stats_t::add_series(const char* name, double hitch_threshold)
+	{
+		series_t s;
+		s.name = name;
+		s.hitch_threshold = hitch_threshold;
+		s.intervals.resize(interval_count);
+		s.interval_hitches.resize(interval_count, 0);
+		series.push_back(std::move(s));
+		return series.size() - 1;
+	}
+
+	void frame_stats_t::record_frame(double seconds)
+	{
+		// The frame that crosses an interval boundary starts the next interval
+		interval_time += seconds;
+		if (interval_time >= interval)
+		{
+			interval_time = std::fmod(interval_time, interval);
+			current = (current + 1) % interval_count;
+			for (series_t& s : series)
+			{
+				s.intervals[current].reset();
+				s.interval_hitches[current] = 0;
+			}
+		}
+
+		record(FRAME, seconds);
+	}
+
+	void frame_stats_t::record(size_t series_index, double seconds)
+	{
+		series_t& s = series[series_index];
+		s.all.record(seconds);
+		s.intervals[current].record(seconds);
+
+		if (seconds > s.hitch_threshold)
+		{
+			s.all_hitches++;
+			s.interval_hitches[current]++;
+		}
+	}
+
+	void frame_stats_t::reset()
+	{
+		for (series_t& s : series)
+		{
+			s.all.reset();
+			s.all_hitches = 0;
+			for (histogram_t& h : s.intervals)
+				h.reset();
+			std::fill(s.interval_hitches.begin(), s.interval_hitches.end(), 0);
+		}
+		interval_time = 0.0;
+		current = 0;
+	}
+
+	frame_stats_snapshot_t frame_stats_t::snapshot(size_t series_index, window_t window)const
+	{
+		const series_t& s = series[series_index];
+
+		histogram_t merged;
+		const histogram_t* h = &s.all;
+		uint64_t hitches = s.all_hitches;
+		if (window == RECENT)
+		{
+			hitches = 0;
+			for (size_t i = 0; i < interval_count; i++)
+			{
+				merged.merge(s.intervals[i]);
+				hitches += s.interval_hitches[i];
+			}
+			h = &merged;
+		}
+
+		frame_stats_snapshot_t snap;
+		snap.name = s.name;
+		snap.count = h->count();
+		snap.mean = h->mean();
+		snap.p50 = h->percentile(50.0);
+		snap.p95 = h->percentile(95.0);
+		snap.p99 = h->percentile(99.0);
+		snap.max = h->max();
+		snap.hitches = hitches;
+		return snap;
+	}
+
+	bool frame_stats_t::write_csv(const char* path)const
+	{
+		FILE* file = fopen(path, "w");
+		if (!file)
+			return false;
+
+		fprintf(file, "series,window,count,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,hitches\n");
+		for (size_t i = 0; i < series.size(); i++)
+		{
+			for (window_t window : { ALL, RECENT })
+			{
+				frame_stats_snapshot_t s = snapshot(i, window);
+				fprintf(file, "%s,%s,%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%llu\n", s.name.c_str(), window == ALL ? "all" : "recent",
+					(unsigned long long)s.count, s.mean * 1e3, s.p50 * 1e3, s.p95 * 1e3, s.p99 * 1e3, s.max * 1e3, (unsigned long long)s.hitches);
+			}
+		}
+
+		return fclose(file) == 0;
+	}
+}
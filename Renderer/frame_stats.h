@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace end
+{
+	// Log-linear histogram of durations (HdrHistogram style) in fixed memory.
+	//
+	//	Microsecond resolution below 128 us, above that every power of two is split in 64,
+	//	so any reported value is within 1.6% of what was recorded. Covers up to ~67 s,
+	//	longer values land in the last bucket (max stays exact).
+	class histogram_t
+	{
+	public:
+
+		static constexpr int SUB_BITS = 7;
+		static constexpr uint64_t SUB_COUNT = 1ull << SUB_BITS;
+		static constexpr int MAX_BITS = 26;
+		static constexpr size_t BUCKET_COUNT = (MAX_BITS - SUB_BITS + 1) * (SUB_COUNT / 2) + SUB_COUNT / 2;
+
+		void record(double seconds);
+		void merge(const histogram_t& other);
+		void reset();
+
+		uint64_t count()const { return total; }
+
+		// Seconds, 0 when empty. p in [0, 100], the value at or below which p percent of samples fall.
+		double percentile(double p)const;
+		double mean()const { return total ? sum_us / total * 1e-6 : 0.0; }
+		double max()const { return max_us * 1e-6; }
+
+	private:
+
+		static size_t bucket_of(uint64_t us);
+		static uint64_t bucket_high(size_t bucket); // largest value the bucket holds
+
+		std::array<uint32_t, BUCKET_COUNT> counts{};
+		uint64_t total = 0;
+		double sum_us = 0.0;
+		uint64_t max_us = 0;
+	};
+
+	struct frame_stats_snapshot_t
+	{
+		std::string name;
+		uint64_t count = 0;
+		double mean = 0.0, p50 = 0.0, p95 = 0.0, p99 = 0.0, max = 0.0; // seconds
+		uint64_t hitches = 0; // samples over the series' hitch threshold
+	};
+
+	// Frame and per stage times.
+	//
+	//	Series 0 is the whole frame, add_series adds stages. Every series keeps a histogram since
+	//	the last reset plus a ring of interval histograms for the rolling window.
+	//	Intervals advance on recorded frame time, not the wall clock, so replays give the same windows.
+	class frame_stats_t
+	{
+	public:
+
+		enum window_t { ALL, RECENT };
+
+		static constexpr size_t FRAME = 0;
+
+		// Rolling window of interval_count intervals of interval seconds.
+		// hitch_threshold is for series 0, frames longer than it count as hitches.
+		explicit frame_stats_t(double hitch_threshold = 1.0 / 30.0, double interval = 1.0, size_t interval_count = 10);
+
+		size_t add_series(const char* name, double hitch_threshold);
+		size_t series_count()const { return series.size(); }
+
+		// Once per frame, also advances the rolling window
+		void record_frame(double seconds);
+		void record(size_t series_index, double seconds);
+
+		void reset();
+
+		frame_stats_snapshot_t snapshot(size_t series_index, window_t window = RECENT)const;
+
+		// One row per series and window, times in milliseconds
+		bool write_csv(const char* path)const;
+
+	private:
+
+		struct series_t
+		{
+			std::string name;
+			double hitch_threshold = 0.0;
+			histogram_t all;
+			std::vector<histogram_t> intervals;
+			uint64_t all_hitches = 0;
+			std::vector<uint64_t> interval_hitches;
+		};
+
+		std::vector<series_t> series;
+		double interval = 1.0;
+		double interval_time = 0.0;
+		size_t interval_count = 10;
+		size_t current = 0;
+	};
+
+	// Records the scope's wall time into a series
+	class stage_timer_t
+	{
+	public:
+
+		stage_timer_t(frame_stats_t& stats, size_t series_index)
+			: stats(stats), series_index(series_index), start(std::chrono::steady_clock::now()) {}
+
+		~stage_timer_t()
+		{
+			stats.record(series_index, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+		}
+
+		stage_timer_t(const stage_timer_t&) = delete;
+		stage_timer_t& operator=(const stage_timer_t&) = delete;
+
+	private:
+
+		frame_stats_t& stats;
+		size_t series_index;
+		std::chrono::steady_clock::time_point start;
+	};
+}
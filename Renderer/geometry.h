@@ -0,0 +1,223 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "math_types.h"
+#include "shaders/cube_tables.hlsli"
+
+// Compile time geometry for helpers and debug drawing.
+//
+//	Everything here is constexpr, so `static constexpr auto grid = geometry::grid_lines<10>(1.0f);`
+//	is baked into the binary and costs nothing per frame.
+//	Line lists are point pairs, ready for debug_renderer::add_lines.
+//	Meshes are positions plus a 16 bit triangle list (clockwise front faces like the cube tables).
+namespace end
+{
+	namespace geometry
+	{
+		template<size_t V, size_t I>
+		struct mesh_t
+		{
+			std::array<float3, V> verts{};
+			std::array<uint16_t, I> indices{};
+		};
+
+		template<size_t N>
+		using line_list_t = std::array<float3, N * 2>;
+
+		constexpr float PI = 3.14159265358979f;
+
+		// constexpr sin/cos, std ones aren't usable at compile time
+		constexpr double cx_sin(double x)
+		{
+			// Into [-pi, pi], the series is accurate to ~1e-9 there
+			const double two_pi = 6.283185307179586;
+			long long turns = (long long)(x / two_pi + (x >= 0.0 ? 0.5 : -0.5));
+			x -= turns * two_pi;
+
+			double term = x;
+			double sum = x;
+			for (int n = 1; n < 12; n++)
+			{
+				term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+				sum += term;
+			}
+			return sum;
+		}
+
+		constexpr double cx_cos(double x) { return cx_sin(x + 1.5707963267948966); }
+
+		// The 12 edges of the shader's cube scaled by half_extent
+		constexpr line_list_t<12> cube_lines(float half_extent = 1.0f)
+		{
+			line_list_t<12> lines{};
+			size_t n = 0;
+			for (int i = 0; i < 8; i++)
+			{
+				for (int bit = 1; bit < 8; bit <<= 1)
+				{
+					if (i & bit)
+						continue;
+
+					const float4& a = cube_tables::cube_v[i];
+					const float4& b = cube_tables::cube_v[i | bit];
+					lines[n++] = { a.x * half_extent, a.y * half_extent, a.z * half_extent };
+					lines[n++] = { b.x * half_extent, b.y * half_extent, b.z * half_extent };
+				}
+			}
+			return lines;
+		}
+
+		// Lines on the xz plane from -half_count to half_count (in spacing units) on both axes
+		template<int half_count>
+		constexpr line_list_t<2 * (2 * half_count + 1)> grid_lines(float spacing = 1.0f)
+		{
+			line_list_t<2 * (2 * half_count + 1)> lines{};
+			const float extent = half_count * spacing;
+			size_t n = 0;
+			for (int i = -half_count; i <= half_count; i++)
+			{
+				lines[n++] = { extent, 0.0f, i * spacing };
+				lines[n++] = { -extent, 0.0f, i * spacing };
+			}
+			for (int i = -half_count; i <= half_count; i++)
+			{
+				lines[n++] = { i * spacing, 0.0f, extent };
+				lines[n++] = { i * spacing, 0.0f, -extent };
+			}
+			return lines;
+		}
+
+		// Origin to +x, +y, +z
+		constexpr line_list_t<3> axes_lines(float length = 1.0f)
+		{
+			return { { { 0.0f, 0.0f, 0.0f }, { length, 0.0f, 0.0f },
+				{ 0.0f, 0.0f, 0.0f }, { 0.0f, length, 0.0f },
+				{ 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, length } } };
+		}
+
+		// Corner k of a camera space frustum: bit 0 = right, bit 1 = top, bit 2 = far.
+		// x and y are scaled by the half width/height at the corner's depth, z is 0 on the near plane and 1 on the far one.
+		constexpr std::array<float3, 8> unit_frustum_corners = { {
+			{ -1.0f, -1.0f, 0.0f }, { 1.0f, -1.0f, 0.0f }, { -1.0f, 1.0f, 0.0f }, { 1.0f, 1.0f, 0.0f },
+			{ -1.0f, -1.0f, 1.0f }, { 1.0f, -1.0f, 1.0f }, { -1.0f, 1.0f, 1.0f }, { 1.0f, 1.0f, 1.0f } } };
+
+		// Camera space frustum (looking down +z) for a vertical fov in radians
+		constexpr line_list_t<12> frustum_lines(float fov_y, float aspect, float near_z, float far_z)
+		{
+			const float tan_half = (float)(cx_sin(fov_y * 0.5) / cx_cos(fov_y * 0.5));
+
+			float3 c[8]{};
+			for (int k = 0; k < 8; k++)
+			{
+				const float3& u = unit_frustum_corners[k];
+				float z = u.z > 0.0f ? far_z : near_z;
+				float h = z * tan_half;
+				c[k] = { u.x * h * aspect, u.y * h, z };
+			}
+
+			line_list_t<12> lines{};
+			size_t n = 0;
+			for (int k = 0; k < 8; k++)
+			{
+				for (int bit = 1; bit < 8; bit <<= 1)
+				{
+					if (k & bit)
+						continue;
+					lines[n++] = c[k];
+					lines[n++] = c[k | bit];
+				}
+			}
+			return lines;
+		}
+
+		// Three great circles (xy, yz, zx planes)
+		template<size_t segments>
+		constexpr line_list_t<3 * segments> sphere_lines(float radius = 1.0f)
+		{
+			line_list_t<3 * segments> lines{};
+			size_t n = 0;
+			for (int plane = 0; plane < 3; plane++)
+			{
+				for (size_t s = 0; s < segments; s++)
+				{
+					for (size_t end = 0; end < 2; end++)
+					{
+						double angle = 2.0 * PI * (double)((s + end) % segments) / segments;
+						float u = (float)(cx_cos(angle) * radius);
+						float v = (float)(cx_sin(angle) * radius);
+
+						if (plane == 0)
+							lines[n++] = { u, v, 0.0f };
+						else if (plane == 1)
+							lines[n++] = { 0.0f, u, v };
+						else
+							lines[n++] = { v, 0.0f, u };
+					}
+				}
+			}
+			return lines;
+		}
+
+		// UV sphere, poles on y. slices around, stacks from pole to pole.
+		template<size_t slices, size_t stacks>
+		constexpr mesh_t<(stacks - 1) * slices + 2, 6 * slices * (stacks - 1)> sphere_mesh(float radius = 1.0f)
+		{
+			static_assert(slices >= 3 && stacks >= 2, "sphere needs at least 3 slices and 2 stacks");
+			static_assert((stacks - 1) * slices + 2 <= 0xFFFF, "too many vertices for 16 bit indices");
+
+			mesh_t<(stacks - 1) * slices + 2, 6 * slices * (stacks - 1)> mesh{};
+
+			const uint16_t top = 0;
+			const uint16_t bottom = (uint16_t)((stacks - 1) * slices + 1);
+			mesh.verts[top] = { 0.0f, radius, 0.0f };
+			mesh.verts[bottom] = { 0.0f, -radius, 0.0f };
+
+			for (size_t st = 1; st < stacks; st++)
+			{
+				double phi = PI * (double)st / stacks;
+				for (size_t sl = 0; sl < slices; sl++)
+				{
+					double theta = 2.0 * PI * (double)sl / slices;
+					mesh.verts[1 + (st - 1) * slices + sl] = {
+						(float)(cx_sin(phi) * cx_cos(theta) * radius),
+						(float)(cx_cos(phi) * radius),
+						(float)(cx_sin(phi) * cx_sin(theta) * radius) };
+				}
+			}
+
+			auto ring = [](size_t st, size_t sl) { return (uint16_t)(1 + (st - 1) * slices + sl % slices); };
+
+			size_t n = 0;
+			for (size_t sl = 0; sl < slices; sl++)
+			{
+				// Caps
+				mesh.indices[n++] = top;
+				mesh.indices[n++] = ring(1, sl + 1);
+				mesh.indices[n++] = ring(1, sl);
+
+				mesh.indices[n++] = bottom;
+				mesh.indices[n++] = ring(stacks - 1, sl);
+				mesh.indices[n++] = ring(stacks - 1, sl + 1);
+			}
+
+			for (size_t st = 1; st + 1 < stacks; st++)
+			{
+				for (size_t sl = 0; sl < slices; sl++)
+				{
+					mesh.indices[n++] = ring(st, sl);
+					mesh.indices[n++] = ring(st + 1, sl + 1);
+					mesh.indices[n++] = ring(st + 1, sl);
+
+					mesh.indices[n++] = ring(st, sl);
+					mesh.indices[n++] = ring(st, sl + 1);
+					mesh.indices[n++] = ring(st + 1, sl + 1);
+				}
+			}
+
+			return mesh;
+		}
+	}
+}
@@ -0,0 +1,155 @@
+#include "job_system.h"
+
+#include <string>
+
+#include "profiler.h"
+
+namespace end
+{
+	job_system_t::job_system_t(int thread_count)
+	{
+		if (thread_count < 0)
+		{
+			int hw = (int)std::thread::hardware_concurrency();
+			thread_count = hw > 1 ? hw - 1 : 0;
+		}
+
+		for (int i = 0; i < thread_count; i++)
+			workers.emplace_back(new worker_t);
+
+		for (size_t i = 0; i < workers.size(); i++)
+			workers[i]->thread = std::thread(&job_system_t::worker_loop, this, i);
+	}
+
+	job_system_t::~job_system_t()
+	{
+		{
+			std::lock_guard<std::mutex> guard(sleep_lock);
+			quit = true;
+		}
+		wake.notify_all();
+
+		for (auto& w : workers)
+			w->thread.join();
+	}
+
+	void job_system_t::parallel_for(size_t count, size_t chunk_size, const range_fn_t& fn)
+	{
+		if (count == 0)
+			return;
+
+		if (chunk_size == 0)
+			chunk_size = 1;
+
+		size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+
+		if (workers.empty() || chunk_count == 1)
+		{
+			for (size_t first = 0; first < count; first += chunk_size)
+				fn(first, first + chunk_size < count ? first + chunk_size : count);
+			return;
+		}
+
+		std::atomic<size_t> remaining{ chunk_count };
+
+		// Contiguous runs of chunks per worker so neighbouring data stays on one core unless stolen
+		size_t per_worker = (chunk_count + workers.size() - 1) / workers.size();
+		for (size_t w = 0; w < workers.size(); w++)
+		{
+			size_t first_chunk = w * per_worker;
+			size_t last_chunk = first_chunk + per_worker < chunk_count ? first_chunk + per_worker : chunk_count;
+			if (first_chunk >= last_chunk)
+				break;
+
+			std::lock_guard<std::mutex> guard(workers[w]->lock);
+			for (size_t c = first_chunk; c < last_chunk; c++)
+			{
+				task_t task;
+				task.fn = &fn;
+				task.first = c * chunk_size;
+				task.last = task.first + chunk_size < count ? task.first + chunk_size : count;
+				task.remaining = &remaining;
+
+				// Owner pops from the back, so push in reverse to run in order
+				workers[w]->tasks.push_front(task);
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(sleep_lock);
+			pending += chunk_count;
+		}
+		wake.notify_all();
+
+		// Help out until every chunk has finished
+		task_t task;
+		while (remaining.load(std::memory_order_acquire) > 0)
+		{
+			if (steal(workers.size(), task))
+				run(task);
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	void job_system_t::worker_loop(size_t index)
+	{
+		profiler::set_thread_name(("worker " + std::to_string(index)).c_str());
+
+		task_t task;
+		for (;;)
+		{
+			if (pop_local(index, task) || steal(index, task))
+			{
+				run(task);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> guard(sleep_lock);
+			wake.wait(guard, [this] { return quit || pending.load() > 0; });
+			if (quit)
+				return;
+		}
+	}
+
+	bool job_system_t::pop_local(size_t index, task_t& out)
+	{
+		worker_t& w = *workers[index];
+		std::lock_guard<std::mutex> guard(w.lock);
+		if (w.tasks.empty())
+			return false;
+
+		out = w.tasks.back();
+		w.tasks.pop_back();
+		--pending;
+		return true;
+	}
+
+	bool job_system_t::steal(size_t thief, task_t& out)
+	{
+		size_t n = workers.size();
+		for (size_t i = 1; i <= n; i++)
+		{
+			size_t victim = (thief + i) % n;
+			if (victim == thief)
+				continue;
+
+			worker_t& w = *workers[victim];
+			std::lock_guard<std::mutex> guard(w.lock);
+			if (w.tasks.empty())
+				continue;
+
+			out = w.tasks.front();
+			w.tasks.pop_front();
+			--pending;
+			return true;
+		}
+		return false;
+	}
+
+	void job_system_t::run(const task_t& task)
+	{
+		(*task.fn)(task.first, task.last);
+		task.remaining->fetch_sub(1, std::memory_order_release);
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace end
+{
+	// Work-stealing thread pool for data parallel loops.
+	//
+	//	Every worker owns a deque. A worker takes its own work from the back and,
+	//	when it runs dry, steals from the front of the other deques. The thread calling
+	//	parallel_for also steals until the loop is done, so a pool with 0 workers just
+	//	runs everything inline.
+	//
+	//	Nested parallel_for calls from inside a job are not supported.
+	class job_system_t
+	{
+	public:
+
+		using range_fn_t = std::function<void(size_t first, size_t last)>;
+
+		// thread_count is the number of worker threads,
+		// -1 (default) uses one less than the hardware threads since the caller helps
+		explicit job_system_t(int thread_count = -1);
+		~job_system_t();
+
+		job_system_t(const job_system_t&) = delete;
+		job_system_t& operator=(const job_system_t&) = delete;
+
+		// Calls fn(first, last) over [0, count) in chunks of chunk_size and blocks until all chunks ran.
+		// Chunks are handed to the workers in order, chunk boundaries don't depend on the thread count.
+		void parallel_for(size_t count, size_t chunk_size, const range_fn_t& fn);
+
+		// Worker threads plus the calling thread
+		unsigned thread_count()const { return (unsigned)workers.size() + 1; }
+
+	private:
+
+		struct task_t
+		{
+			const range_fn_t* fn = nullptr;
+			size_t first = 0;
+			size_t last = 0;
+			std::atomic<size_t>* remaining = nullptr;
+		};
+
+		struct worker_t
+		{
+			std::mutex lock;
+			std::deque<task_t> tasks;
+			std::thread thread;
+		};
+
+		void worker_loop(size_t index);
+
+		bool pop_local(size_t index, task_t& out);
+		bool steal(size_t thief, task_t& out);
+		void run(const task_t& task);
+
+		std::vector<std::unique_ptr<worker_t>> workers;
+
+		std::mutex sleep_lock;
+		std::condition_variable wake;
+		std::atomic<size_t> pending{ 0 };
+		bool quit = false;
+	};
+}
@@ -0,0 +1,154 @@
+#include "lod.h"
+
+#include <emmintrin.h>
+
+namespace
+{
+	// Projected diameter in pixels of a sphere of radius r at distance d is
+	//		size = r * proj[1][1] * viewport_height / d
+	// so size >= t  <=>  (r * k)^2 >= (t * d)^2  with k = proj[1][1] * viewport_height
+	// and every comparison can stay squared.
+	inline float pixel_scale(const end::float4x4_a& proj, const end::lod_settings_t& settings)
+	{
+		return proj[1][1] * settings.viewport_height;
+	}
+}
+
+namespace end
+{
+	size_t select_lods(const aabb_soa_view_t& boxes, const uint32_t* indices, size_t count,
+		const float3& eye, const float4x4_a& proj, const lod_settings_t& settings,
+		uint32_t* out_indices, uint8_t* out_lods)
+	{
+		const float k = pixel_scale(proj, settings);
+
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 k2 = _mm_set1_ps(k * k);
+		const __m128 eye_x = _mm_set1_ps(eye.x);
+		const __m128 eye_y = _mm_set1_ps(eye.y);
+		const __m128 eye_z = _mm_set1_ps(eye.z);
+		const __m128 min_size2 = _mm_set1_ps(settings.min_screen_size * settings.min_screen_size);
+		const __m128i one = _mm_set1_epi32(1);
+
+		__m128 band2[MAX_LOD_BANDS];
+		for (int b = 0; b < settings.band_count; b++)
+			band2[b] = _mm_set1_ps(settings.bands[b] * settings.bands[b]);
+
+		size_t kept = 0;
+		size_t i = 0;
+
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 mnx, mny, mnz, mxx, mxy, mxz;
+			alignas(16) uint32_t idx[4];
+
+			if (indices)
+			{
+				for (int l = 0; l < 4; l++)
+					idx[l] = indices[i + l];
+
+				mnx = _mm_setr_ps(boxes.min_x[idx[0]], boxes.min_x[idx[1]], boxes.min_x[idx[2]], boxes.min_x[idx[3]]);
+				mny = _mm_setr_ps(boxes.min_y[idx[0]], boxes.min_y[idx[1]], boxes.min_y[idx[2]], boxes.min_y[idx[3]]);
+				mnz = _mm_setr_ps(boxes.min_z[idx[0]], boxes.min_z[idx[1]], boxes.min_z[idx[2]], boxes.min_z[idx[3]]);
+				mxx = _mm_setr_ps(boxes.max_x[idx[0]], boxes.max_x[idx[1]], boxes.max_x[idx[2]], boxes.max_x[idx[3]]);
+				mxy = _mm_setr_ps(boxes.max_y[idx[0]], boxes.max_y[idx[1]], boxes.max_y[idx[2]], boxes.max_y[idx[3]]);
+				mxz = _mm_setr_ps(boxes.max_z[idx[0]], boxes.max_z[idx[1]], boxes.max_z[idx[2]], boxes.max_z[idx[3]]);
+			}
+			else
+			{
+				for (int l = 0; l < 4; l++)
+					idx[l] = (uint32_t)(i + l);
+
+				mnx = _mm_loadu_ps(boxes.min_x + i);
+				mny = _mm_loadu_ps(boxes.min_y + i);
+				mnz = _mm_loadu_ps(boxes.min_z + i);
+				mxx = _mm_loadu_ps(boxes.max_x + i);
+				mxy = _mm_loadu_ps(boxes.max_y + i);
+				mxz = _mm_loadu_ps(boxes.max_z + i);
+			}
+
+			// Bounding sphere radius^2 = |extents|^2
+			__m128 ex = _mm_mul_ps(_mm_sub_ps(mxx, mnx), half);
+			__m128 ey = _mm_mul_ps(_mm_sub_ps(mxy, mny), half);
+			__m128 ez = _mm_mul_ps(_mm_sub_ps(mxz, mnz), half);
+			__m128 r2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey)), _mm_mul_ps(ez, ez));
+
+			// Distance^2 from the eye to the center
+			__m128 dx = _mm_sub_ps(_mm_add_ps(mnx, ex), eye_x);
+			__m128 dy = _mm_sub_ps(_mm_add_ps(mny, ey), eye_y);
+			__m128 dz = _mm_sub_ps(_mm_add_ps(mnz, ez), eye_z);
+			__m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+			// Camera inside the sphere counts as huge
+			__m128 inside = _mm_cmple_ps(d2, r2);
+			__m128 lhs = _mm_mul_ps(r2, k2);
+
+			__m128 keep = _mm_or_ps(inside, _mm_cmpge_ps(lhs, _mm_mul_ps(min_size2, d2)));
+			int keep_mask = _mm_movemask_ps(keep);
+			if (keep_mask == 0)
+				continue;
+
+			// LOD = number of bands the size falls below
+			__m128i lod = _mm_setzero_si128();
+			for (int b = 0; b < settings.band_count; b++)
+			{
+				__m128 below = _mm_andnot_ps(inside, _mm_cmplt_ps(lhs, _mm_mul_ps(band2[b], d2)));
+				lod = _mm_add_epi32(lod, _mm_and_si128(_mm_castps_si128(below), one));
+			}
+
+			alignas(16) int32_t lods[4];
+			_mm_store_si128((__m128i*)lods, lod);
+
+			for (int l = 0; l < 4; l++)
+			{
+				if (keep_mask & (1 << l))
+				{
+					out_indices[kept] = idx[l];
+					if (out_lods)
+						out_lods[kept] = (uint8_t)lods[l];
+					kept++;
+				}
+			}
+		}
+
+		for (; i < count; i++)
+		{
+			uint32_t index = indices ? indices[i] : (uint32_t)i;
+			uint8_t lod = select_lod(boxes.get(index), eye, proj, settings);
+			if (lod == LOD_CULLED)
+				continue;
+
+			out_indices[kept] = index;
+			if (out_lods)
+				out_lods[kept] = lod;
+			kept++;
+		}
+
+		return kept;
+	}
+
+	uint8_t select_lod(const aabb_t& box, const float3& eye, const float4x4_a& proj, const lod_settings_t& settings)
+	{
+		const float k = pixel_scale(proj, settings);
+
+		float3 e = box.extents();
+		float3 d = box.center() - eye;
+		float r2 = dot(e, e);
+		float d2 = dot(d, d);
+
+		if (d2 <= r2)
+			return 0;
+
+		float lhs = r2 * k * k;
+		if (lhs < settings.min_screen_size * settings.min_screen_size * d2)
+			return LOD_CULLED;
+
+		uint8_t lod = 0;
+		for (int b = 0; b < settings.band_count; b++)
+		{
+			if (lhs < settings.bands[b] * settings.bands[b] * d2)
+				lod++;
+		}
+		return lod;
+	}
+}
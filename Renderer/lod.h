@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+#include "bounds.h"
+
+namespace end
+{
+	constexpr int MAX_LOD_BANDS = 4;
+
+	// Marks a box that is too small on screen to be drawn
+	constexpr uint8_t LOD_CULLED = 0xFF;
+
+	struct lod_settings_t
+	{
+		// Boxes projecting to fewer pixels than this (bounding sphere diameter) are dropped
+		float min_screen_size = 1.0f;
+
+		// Render target height in pixels
+		float viewport_height = 720.0f;
+
+		// Pixel sizes where the next LOD starts, largest first.
+		// Size >= bands[0] is LOD 0, bands[0] > size >= bands[1] is LOD 1 and so on.
+		float bands[MAX_LOD_BANDS] = { 64.0f, 16.0f, 4.0f, 0.0f };
+		int band_count = 3;
+	};
+
+	// Screen size and LOD stage, runs after frustum culling.
+	//
+	//	boxes:		all boxes
+	//	indices:	the frustum survivors to look at, nullptr means every box in order
+	//	count:		number of indices (or boxes)
+	//	eye:		camera position, row 3 of the view_t::view_mat
+	//	proj:		view_t::proj_mat, only the vertical scale [1][1] is used
+	//
+	// Writes the kept box indices and their LOD to out_indices/out_lods (both sized for count)
+	// in input order and returns how many were kept. out_lods may be nullptr.
+	// Works on 4 boxes at a time with SSE and never takes a square root.
+	size_t select_lods(const aabb_soa_view_t& boxes, const uint32_t* indices, size_t count,
+		const float3& eye, const float4x4_a& proj, const lod_settings_t& settings,
+		uint32_t* out_indices, uint8_t* out_lods);
+
+	// Single box version, returns LOD_CULLED when too small
+	uint8_t select_lod(const aabb_t& box, const float3& eye, const float4x4_a& proj, const lod_settings_t& settings);
+}
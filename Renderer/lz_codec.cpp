@@ -0,0 +1,347 @@
+#include "lz_codec.h"
+
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+namespace end
+{
+	namespace
+	{
+		constexpr size_t MIN_MATCH = 4;
+		constexpr size_t LAST_LITERALS = 5;	// the block always ends with this many literals
+		constexpr size_t MF_LIMIT = 12;		// no match starts in the last 12 bytes
+		constexpr size_t MAX_OFFSET = 65535;
+		constexpr int HASH_BITS = 14;
+
+		constexpr uint32_t CHUNKED_MAGIC = 0x31435A4C; // "LZC1"
+		constexpr uint32_t CHUNK_RAW = 0x80000000u;	   // set in a chunk's stored size when it isn't compressed
+
+		struct chunked_header_t
+		{
+			uint32_t magic;
+			uint32_t chunk_size;
+			uint64_t size;
+			uint32_t chunk_count;
+			uint32_t reserved;
+		};
+		static_assert(sizeof(chunked_header_t) == 24, "chunked header layout");
+
+		inline uint32_t read32(const uint8_t* p)
+		{
+			uint32_t v;
+			memcpy(&v, p, 4);
+			return v;
+		}
+
+		inline uint32_t hash4(uint32_t v)
+		{
+			return (v * 2654435761u) >> (32 - HASH_BITS);
+		}
+
+		// 15 in the token then 255s until the rest fits in a byte
+		inline uint8_t* write_length(uint8_t* op, size_t length)
+		{
+			for (; length >= 255; length -= 255)
+				*op++ = 255;
+			*op++ = (uint8_t)length;
+			return op;
+		}
+
+		uint8_t* write_sequence(uint8_t* op, const uint8_t* literals, size_t literal_count, size_t offset, size_t match_length)
+		{
+			uint8_t* token = op++;
+			size_t ml = match_length - MIN_MATCH;
+
+			*token = (uint8_t)((literal_count >= 15 ? 15 : literal_count) << 4);
+			if (literal_count >= 15)
+				op = write_length(op, literal_count - 15);
+
+			memcpy(op, literals, literal_count);
+			op += literal_count;
+
+			*op++ = (uint8_t)offset;
+			*op++ = (uint8_t)(offset >> 8);
+
+			*token |= (uint8_t)(ml >= 15 ? 15 : ml);
+			if (ml >= 15)
+				op = write_length(op, ml - 15);
+			return op;
+		}
+
+		uint8_t* write_last_literals(uint8_t* op, const uint8_t* literals, size_t literal_count)
+		{
+			*op++ = (uint8_t)((literal_count >= 15 ? 15 : literal_count) << 4);
+			if (literal_count >= 15)
+				op = write_length(op, literal_count - 15);
+			memcpy(op, literals, literal_count);
+			return op + literal_count;
+		}
+
+		// Reads a 15 + 255 + ... length continuation, false past the end
+		inline bool read_length(const uint8_t*& ip, const uint8_t* end, size_t& length)
+		{
+			uint8_t b;
+			do
+			{
+				if (ip >= end)
+					return false;
+				b = *ip++;
+				length += b;
+			} while (b == 255);
+			return true;
+		}
+	}
+
+	size_t lz_compress_bound(size_t size)
+	{
+		return size + size / 255 + 16;
+	}
+
+	size_t lz_compress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity)
+	{
+		if (capacity < lz_compress_bound(size))
+			return 0;
+
+		uint8_t* op = dst;
+		const uint8_t* anchor = src;
+		const uint8_t* end = src + size;
+
+		if (size >= MF_LIMIT + 1)
+		{
+			std::vector<uint32_t> table(1 << HASH_BITS, 0);
+			const uint8_t* ip = src + 1;
+			const uint8_t* mf_limit = end - MF_LIMIT;
+			const uint8_t* match_limit = end - LAST_LITERALS;
+
+			while (ip < mf_limit)
+			{
+				uint32_t seq = read32(ip);
+				uint32_t h = hash4(seq);
+				const uint8_t* ref = src + table[h];
+				table[h] = (uint32_t)(ip - src);
+
+				if (ref >= ip || (size_t)(ip - ref) > MAX_OFFSET || read32(ref) != seq)
+				{
+					// Skip faster through data that doesn't match
+					ip += 1 + ((ip - anchor) >> 6);
+					continue;
+				}
+
+				while (ip > anchor && ref > src && ip[-1] == ref[-1])
+				{
+					ip--;
+					ref--;
+				}
+
+				size_t length = MIN_MATCH;
+				while (ip + length < match_limit && ip[length] == ref[length])
+					length++;
+
+				op = write_sequence(op, anchor, (size_t)(ip - anchor), (size_t)(ip - ref), length);
+				ip += length;
+				anchor = ip;
+
+				// Give the position just before the next search a table entry too
+				if (ip < mf_limit)
+					table[hash4(read32(ip - 2))] = (uint32_t)(ip - 2 - src);
+			}
+		}
+
+		op = write_last_literals(op, anchor, (size_t)(end - anchor));
+		return (size_t)(op - dst);
+	}
+
+	bool lz_decompress(const uint8_t* src, size_t src_size, uint8_t* dst, size_t dst_size)
+	{
+		const uint8_t* ip = src;
+		const uint8_t* ip_end = src + src_size;
+		uint8_t* op = dst;
+		uint8_t* op_end = dst + dst_size;
+
+		while (ip < ip_end)
+		{
+			uint8_t token = *ip++;
+
+			size_t literal_count = token >> 4;
+			if (literal_count == 15 && !read_length(ip, ip_end, literal_count))
+				return false;
+
+			if (literal_count > (size_t)(ip_end - ip) || literal_count > (size_t)(op_end - op))
+				return false;
+			if (literal_count <= 16 && ip_end - ip >= 16 && op_end - op >= 16)
+				memcpy(op, ip, 16); // fixed size copy, the extra bytes get overwritten
+			else
+				memcpy(op, ip, literal_count);
+			ip += literal_count;
+			op += literal_count;
+
+			// The last sequence has no match
+			if (ip == ip_end)
+				break;
+
+			if (ip_end - ip < 2)
+				return false;
+			size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+			ip += 2;
+			if (offset == 0 || offset > (size_t)(op - dst))
+				return false;
+
+			size_t length = token & 15;
+			if (length == 15 && !read_length(ip, ip_end, length))
+				return false;
+			length += MIN_MATCH;
+			if (length > (size_t)(op_end - op))
+				return false;
+
+			const uint8_t* match = op - offset;
+			if (offset >= 16 && (size_t)(op_end - op) >= ((length + 15) & ~(size_t)15))
+			{
+				// 16 byte steps may run past the match but stay inside dst
+				for (size_t i = 0; i < length; i += 16)
+					memcpy(op + i, match + i, 16);
+				op += length;
+			}
+			else if (offset >= length)
+			{
+				memcpy(op, match, length);
+				op += length;
+			}
+			else
+			{
+				// Overlapping, repeats the last offset bytes
+				for (size_t i = 0; i < length; i++)
+					*op++ = match[i];
+			}
+		}
+
+		return op == op_end;
+	}
+
+	binary_blob_t lz_compress_chunked(const uint8_t* src, size_t size, size_t chunk_size, job_system_t* jobs)
+	{
+		if (chunk_size == 0 || chunk_size >= CHUNK_RAW)
+			chunk_size = LZ_DEFAULT_CHUNK_SIZE;
+
+		size_t chunk_count = (size + chunk_size - 1) / chunk_size;
+		std::vector<binary_blob_t> chunks(chunk_count);
+		std::vector<uint32_t> stored(chunk_count);
+
+		auto compress_chunks = [&](size_t first, size_t last)
+		{
+			for (size_t c = first; c < last; c++)
+			{
+				const uint8_t* in = src + c * chunk_size;
+				size_t in_size = c + 1 < chunk_count ? chunk_size : size - c * chunk_size;
+
+				chunks[c].resize(lz_compress_bound(in_size));
+				size_t out_size = lz_compress(in, in_size, chunks[c].data(), chunks[c].size());
+				if (out_size >= in_size)
+				{
+					chunks[c].assign(in, in + in_size);
+					stored[c] = (uint32_t)in_size | CHUNK_RAW;
+				}
+				else
+				{
+					chunks[c].resize(out_size);
+					stored[c] = (uint32_t)out_size;
+				}
+			}
+		};
+
+		if (jobs)
+			jobs->parallel_for(chunk_count, 1, compress_chunks);
+		else
+			compress_chunks(0, chunk_count);
+
+		chunked_header_t header{ CHUNKED_MAGIC, (uint32_t)chunk_size, (uint64_t)size, (uint32_t)chunk_count, 0 };
+
+		size_t total = sizeof(header) + chunk_count * sizeof(uint32_t);
+		for (const binary_blob_t& c : chunks)
+			total += c.size();
+
+		binary_blob_t out(total);
+		uint8_t* op = out.data();
+		memcpy(op, &header, sizeof(header));
+		op += sizeof(header);
+		if (chunk_count)
+			memcpy(op, stored.data(), chunk_count * sizeof(uint32_t));
+		op += chunk_count * sizeof(uint32_t);
+		for (const binary_blob_t& c : chunks)
+		{
+			if (!c.empty())
+				memcpy(op, c.data(), c.size());
+			op += c.size();
+		}
+		return out;
+	}
+
+	size_t lz_chunked_size(const uint8_t* src, size_t src_size)
+	{
+		chunked_header_t header;
+		if (src_size < sizeof(header))
+			return 0;
+
+		memcpy(&header, src, sizeof(header));
+		return header.magic == CHUNKED_MAGIC ? (size_t)header.size : 0;
+	}
+
+	bool lz_decompress_chunked(const uint8_t* src, size_t src_size, uint8_t* dst, size_t dst_size, job_system_t* jobs)
+	{
+		chunked_header_t header;
+		if (src_size < sizeof(header))
+			return false;
+		memcpy(&header, src, sizeof(header));
+
+		size_t chunk_size = header.chunk_size;
+		size_t chunk_count = header.chunk_count;
+		if (header.magic != CHUNKED_MAGIC || header.size != dst_size || chunk_size == 0 ||
+			chunk_count != (dst_size + chunk_size - 1) / chunk_size ||
+			chunk_count > (src_size - sizeof(header)) / sizeof(uint32_t))
+			return false;
+
+		// Where each chunk's data starts, the table is small so this part is serial
+		std::vector<uint32_t> stored(chunk_count);
+		if (chunk_count)
+			memcpy(stored.data(), src + sizeof(header), chunk_count * sizeof(uint32_t));
+
+		std::vector<size_t> offsets(chunk_count + 1);
+		offsets[0] = sizeof(header) + chunk_count * sizeof(uint32_t);
+		for (size_t c = 0; c < chunk_count; c++)
+			offsets[c + 1] = offsets[c] + (stored[c] & ~CHUNK_RAW);
+		if (offsets[chunk_count] > src_size)
+			return false;
+
+		std::atomic<bool> ok{ true };
+		auto decompress_chunks = [&](size_t first, size_t last)
+		{
+			for (size_t c = first; c < last; c++)
+			{
+				const uint8_t* in = src + offsets[c];
+				size_t in_size = offsets[c + 1] - offsets[c];
+				uint8_t* out = dst + c * chunk_size;
+				size_t out_size = c + 1 < chunk_count ? chunk_size : dst_size - c * chunk_size;
+
+				bool chunk_ok;
+				if (stored[c] & CHUNK_RAW)
+				{
+					chunk_ok = in_size == out_size;
+					if (chunk_ok)
+						memcpy(out, in, out_size);
+				}
+				else
+					chunk_ok = lz_decompress(in, in_size, out, out_size);
+
+				if (!chunk_ok)
+					ok.store(false, std::memory_order_relaxed);
+			}
+		};
+
+		if (jobs)
+			jobs->parallel_for(chunk_count, 1, decompress_chunks);
+		else
+			decompress_chunks(0, chunk_count);
+
+		return ok.load();
+	}
+}
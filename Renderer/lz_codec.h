@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "blob.h"
+#include "job_system.h"
+
+namespace end
+{
+	// Fast LZ77 codec using the LZ4 block format (greedy hash-chain-free matcher, 64 KB window).
+	//
+	//	Blocks: one buffer in, one out, the decompressor checks every read and write.
+	//	Chunked streams: the input is cut into independent blocks so compression and decompression
+	//	can run a chunk per job, each chunk writing straight into its slice of the destination.
+	//	Incompressible chunks are stored raw.
+
+	constexpr size_t LZ_DEFAULT_CHUNK_SIZE = 256 * 1024;
+
+	// Worst case compressed size of size bytes
+	size_t lz_compress_bound(size_t size);
+
+	// Returns the compressed size, 0 if capacity is too small
+	size_t lz_compress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity);
+
+	// dst_size must be the exact decompressed size, false on corrupt input
+	bool lz_decompress(const uint8_t* src, size_t src_size, uint8_t* dst, size_t dst_size);
+
+	binary_blob_t lz_compress_chunked(const uint8_t* src, size_t size, size_t chunk_size = LZ_DEFAULT_CHUNK_SIZE,
+		job_system_t* jobs = nullptr);
+
+	// Decompressed size stored in a chunked stream, 0 if it isn't one
+	size_t lz_chunked_size(const uint8_t* src, size_t src_size);
+
+	// dst_size must match lz_chunked_size, chunks go to the job system when there is one
+	bool lz_decompress_chunked(const uint8_t* src, size_t src_size, uint8_t* dst, size_t dst_size,
+		job_system_t* jobs = nullptr);
+}
@@ -1,16 +1,13 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 
-// DIRECT X STUFF
-#include <dxgi1_2.h>
-#include <d3d11_2.h>
-#include <DirectXMath.h>
-
-#pragma comment(lib, "d2d1.lib")
-#pragma comment(lib, "d3d11.lib")
-#pragma comment(lib, "DXGI.lib")
+// Plain math types, no platform headers. simd_math.h has the SIMD versions.
+#ifndef NOMINMAX
+#define NOMINMAX // Windows.h gets included after this on Windows, keep its min/max macros away from std::min/std::max
+#endif
 
 namespace end
 {
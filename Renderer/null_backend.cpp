@@ -0,0 +1,48 @@
+#include "null_backend.h"
+
+#include "debug_renderer.h"
+
+namespace end
+{
+	namespace
+	{
+		constexpr uint32_t CUBE_VERTEX_COUNT = 36;
+	}
+
+	void null_backend_t::update_mvp(const MVP_t&)
+	{
+		totals.constant_updates++;
+		totals.constant_bytes += sizeof(MVP_t);
+	}
+
+	void null_backend_t::draw_cube()
+	{
+		totals.draw_calls++;
+		totals.vertices += CUBE_VERTEX_COUNT;
+	}
+
+	void null_backend_t::draw_lines(const colored_vertex*, size_t vert_count)
+	{
+		// Counted like the d3d11 backend uploads, clamped to its line buffer
+		size_t capacity = debug_renderer::get_line_vert_capacity();
+		if (vert_count > capacity)
+			vert_count = capacity;
+		if (vert_count == 0)
+			return;
+
+		totals.buffer_uploads++;
+		totals.upload_bytes += vert_count * sizeof(colored_vertex);
+		totals.draw_calls++;
+		totals.vertices += vert_count;
+	}
+
+	void null_backend_t::present()
+	{
+		totals.frames++;
+	}
+
+	std::unique_ptr<render_backend_t> create_null_backend(uint32_t width, uint32_t height)
+	{
+		return std::unique_ptr<render_backend_t>(new null_backend_t(width, height));
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "render_backend.h"
+
+namespace end
+{
+	// Totals of what the frame loop handed the backend since construction or reset_counters()
+	struct render_counters_t
+	{
+		uint64_t frames = 0;
+		uint64_t draw_calls = 0;
+		uint64_t vertices = 0;			// drawn, cube and lines
+		uint64_t buffer_uploads = 0;
+		uint64_t upload_bytes = 0;		// vertex data
+		uint64_t constant_updates = 0;
+		uint64_t constant_bytes = 0;
+	};
+
+	// Backend for headless runs: same calls as the D3D11 one, no device.
+	//
+	//	Each call only bumps counters, so a frame costs what the CPU side of the renderer costs
+	//	(camera, culling, particles, debug lines) plus a few adds, and it runs on any platform.
+	class null_backend_t final : public render_backend_t
+	{
+	public:
+
+		null_backend_t(uint32_t width = 1280, uint32_t height = 720) : target_width(width), target_height(height) {}
+
+		void initialize(asset_loader_t&, job_system_t&) override {}
+
+		float width()const override { return (float)target_width; }
+		float height()const override { return (float)target_height; }
+
+		void begin_frame(const float4&) override {}
+		void update_mvp(const MVP_t& mvp) override;
+		void draw_cube() override;
+		void draw_lines(const colored_vertex* verts, size_t vert_count) override;
+		void present() override;
+
+		const render_counters_t& counters()const { return totals; }
+		void reset_counters() { totals = {}; }
+
+	private:
+
+		uint32_t target_width;
+		uint32_t target_height;
+		render_counters_t totals;
+	};
+}
@@ -0,0 +1,325 @@
+#include "occlusion.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <xmmintrin.h>
+
+namespace
+{
+	// Clip-space w below this is treated as touching the near plane
+	constexpr float NEAR_W = 1e-4f;
+
+	// Box triangles, corner index bits select max.x/y/z (see aabb_t::corners)
+	constexpr uint16_t box_indices[36] =
+	{
+		0,2,1, 1,2,3, // -z
+		4,5,6, 5,7,6, // +z
+		0,1,4, 1,5,4, // -y
+		2,6,3, 3,6,7, // +y
+		0,4,2, 2,4,6, // -x
+		1,3,5, 3,7,5  // +x
+	};
+
+	inline end::float4 transform_point(const end::float4x4_a& m, end::float3 p)
+	{
+		__m128 r = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.x), _mm_loadu_ps(m[0].data())),
+				_mm_mul_ps(_mm_set1_ps(p.y), _mm_loadu_ps(m[1].data()))),
+			_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.z), _mm_loadu_ps(m[2].data())),
+				_mm_loadu_ps(m[3].data())));
+
+		end::float4 out;
+		_mm_storeu_ps(out.data(), r);
+		return out;
+	}
+
+	// Boxes per job when testing
+	constexpr size_t TEST_CHUNK_SIZE = 256;
+}
+
+namespace end
+{
+	occlusion_buffer_t::occlusion_buffer_t(int width, int height)
+	{
+		tiles_x = std::max(1, (width + TILE_SIZE - 1) / TILE_SIZE);
+		tiles_y = std::max(1, (height + TILE_SIZE - 1) / TILE_SIZE);
+		buffer_width = tiles_x * TILE_SIZE;
+		buffer_height = tiles_y * TILE_SIZE;
+
+		depth.resize(buffer_width * buffer_height, 1.0f);
+		tile_max_depth.resize(tiles_x * tiles_y, 1.0f);
+	}
+
+	void occlusion_buffer_t::begin(const float4x4_a& vp)
+	{
+		view_proj = vp;
+		triangles.clear();
+		std::fill(depth.begin(), depth.end(), 1.0f);
+		std::fill(tile_max_depth.begin(), tile_max_depth.end(), 1.0f);
+	}
+
+	void occlusion_buffer_t::add_occluder(const float3* verts, const uint16_t* indices, size_t index_count)
+	{
+		for (size_t i = 0; i + 2 < index_count; i += 3)
+		{
+			float4 clip[3];
+			bool behind = false;
+
+			for (int v = 0; v < 3; v++)
+			{
+				clip[v] = transform_point(view_proj, verts[indices[i + v]]);
+				behind |= clip[v].w < NEAR_W;
+			}
+
+			// Occluders crossing the near plane are dropped, that only makes culling less aggressive
+			if (behind)
+				continue;
+
+			screen_triangle_t tri;
+			for (int v = 0; v < 3; v++)
+			{
+				float inv_w = 1.0f / clip[v].w;
+				tri.x[v] = (clip[v].x * inv_w * 0.5f + 0.5f) * buffer_width;
+				tri.y[v] = (0.5f - clip[v].y * inv_w * 0.5f) * buffer_height;
+				tri.z[v] = std::max(0.0f, clip[v].z * inv_w);
+			}
+
+			// Quick reject of triangles fully off screen
+			float min_x = std::min({ tri.x[0], tri.x[1], tri.x[2] });
+			float max_x = std::max({ tri.x[0], tri.x[1], tri.x[2] });
+			float min_y = std::min({ tri.y[0], tri.y[1], tri.y[2] });
+			float max_y = std::max({ tri.y[0], tri.y[1], tri.y[2] });
+			if (max_x < 0.0f || max_y < 0.0f || min_x >= buffer_width || min_y >= buffer_height)
+				continue;
+
+			triangles.push_back(tri);
+		}
+	}
+
+	void occlusion_buffer_t::add_occluder(const aabb_t& box)
+	{
+		float3 corners[8];
+		box.corners(corners);
+		add_occluder(corners, box_indices, 36);
+	}
+
+	void occlusion_buffer_t::add_occluders(const aabb_soa_view_t& boxes, const uint32_t* indices, size_t count)
+	{
+		for (size_t k = 0; k < count; k++)
+			add_occluder(boxes.get(indices ? indices[k] : k));
+	}
+
+	void occlusion_buffer_t::rasterize(job_system_t* jobs)
+	{
+		if (!jobs)
+		{
+			rasterize_tile_rows(0, tiles_y);
+			return;
+		}
+
+		// Each job owns one tile row so no two threads write the same pixel
+		jobs->parallel_for((size_t)tiles_y, 1, [this](size_t first, size_t last)
+		{
+			rasterize_tile_rows((int)first, (int)last);
+		});
+	}
+
+	void occlusion_buffer_t::rasterize_tile_rows(int first_row, int last_row)
+	{
+		if (first_row >= last_row)
+			return;
+
+		const int band_min_y = first_row * TILE_SIZE;
+		const int band_max_y = last_row * TILE_SIZE - 1;
+
+		const __m128 lane_offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+		const __m128 zero = _mm_setzero_ps();
+
+		for (const screen_triangle_t& src : triangles)
+		{
+			float x0 = src.x[0], y0 = src.y[0], z0 = src.z[0];
+			float x1 = src.x[1], y1 = src.y[1], z1 = src.z[1];
+			float x2 = src.x[2], y2 = src.y[2], z2 = src.z[2];
+
+			float area = (x1 - x0) * (y2 - y0) - (y1 - y0) * (x2 - x0);
+			if (std::fabs(area) < 1e-8f)
+				continue;
+
+			// Make winding consistent so "inside" is always all edges >= 0
+			if (area < 0.0f)
+			{
+				std::swap(x1, x2);
+				std::swap(y1, y2);
+				std::swap(z1, z2);
+				area = -area;
+			}
+
+			int min_x = std::max(0, (int)std::floor(std::min({ x0, x1, x2 })));
+			int max_x = std::min(buffer_width - 1, (int)std::ceil(std::max({ x0, x1, x2 })));
+			int min_y = std::max(band_min_y, (int)std::floor(std::min({ y0, y1, y2 })));
+			int max_y = std::min(band_max_y, (int)std::ceil(std::max({ y0, y1, y2 })));
+
+			if (min_x > max_x || min_y > max_y)
+				continue;
+
+			// SSE works on 4 pixels at a time, buffer_width is a multiple of 4
+			min_x &= ~3;
+
+			// Edge functions E = A*x + B*y + C, edge i is opposite vertex i
+			float a0 = y1 - y2, b0 = x2 - x1, c0 = x1 * y2 - y1 * x2;
+			float a1 = y2 - y0, b1 = x0 - x2, c1 = x2 * y0 - y2 * x0;
+			float a2 = y0 - y1, b2 = x1 - x0, c2 = x0 * y1 - y0 * x1;
+
+			// Depth plane z = za*x + zb*y + zc
+			float inv_area = 1.0f / area;
+			float za = (a0 * z0 + a1 * z1 + a2 * z2) * inv_area;
+			float zb = (b0 * z0 + b1 * z1 + b2 * z2) * inv_area;
+			float zc = (c0 * z0 + c1 * z1 + c2 * z2) * inv_area;
+
+			const __m128 va0 = _mm_set1_ps(a0), va1 = _mm_set1_ps(a1), va2 = _mm_set1_ps(a2);
+			const __m128 vza = _mm_set1_ps(za);
+
+			for (int y = min_y; y <= max_y; y++)
+			{
+				float py = y + 0.5f;
+				__m128 row0 = _mm_set1_ps(b0 * py + c0);
+				__m128 row1 = _mm_set1_ps(b1 * py + c1);
+				__m128 row2 = _mm_set1_ps(b2 * py + c2);
+				__m128 rowz = _mm_set1_ps(zb * py + zc);
+
+				float* dst = &depth[y * buffer_width];
+
+				for (int x = min_x; x <= max_x; x += 4)
+				{
+					__m128 px = _mm_add_ps(_mm_set1_ps((float)x), lane_offsets);
+
+					__m128 e0 = _mm_add_ps(_mm_mul_ps(va0, px), row0);
+					__m128 e1 = _mm_add_ps(_mm_mul_ps(va1, px), row1);
+					__m128 e2 = _mm_add_ps(_mm_mul_ps(va2, px), row2);
+
+					__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+					if (_mm_movemask_ps(inside) == 0)
+						continue;
+
+					__m128 z = _mm_add_ps(_mm_mul_ps(vza, px), rowz);
+					__m128 old_z = _mm_loadu_ps(dst + x);
+					__m128 new_z = _mm_min_ps(old_z, z);
+
+					_mm_storeu_ps(dst + x, _mm_or_ps(_mm_and_ps(inside, new_z), _mm_andnot_ps(inside, old_z)));
+				}
+			}
+		}
+
+		// Refresh the farthest depth of every tile in the band
+		for (int ty = first_row; ty < last_row; ty++)
+		{
+			for (int tx = 0; tx < tiles_x; tx++)
+			{
+				__m128 far_z = _mm_setzero_ps();
+				for (int y = 0; y < TILE_SIZE; y++)
+				{
+					const float* src = &depth[(ty * TILE_SIZE + y) * buffer_width + tx * TILE_SIZE];
+					for (int x = 0; x < TILE_SIZE; x += 4)
+						far_z = _mm_max_ps(far_z, _mm_loadu_ps(src + x));
+				}
+
+				alignas(16) float lanes[4];
+				_mm_store_ps(lanes, far_z);
+				tile_max_depth[ty * tiles_x + tx] = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+			}
+		}
+	}
+
+	bool occlusion_buffer_t::test(const aabb_t& box)const
+	{
+		float3 corners[8];
+		box.corners(corners);
+
+		float min_x = FLT_MAX, min_y = FLT_MAX, max_x = -FLT_MAX, max_y = -FLT_MAX;
+		float min_z = FLT_MAX;
+
+		for (int i = 0; i < 8; i++)
+		{
+			float4 clip = transform_point(view_proj, corners[i]);
+
+			// Touching the near plane, can't bound it on screen
+			if (clip.w < NEAR_W)
+				return true;
+
+			float inv_w = 1.0f / clip.w;
+			float sx = (clip.x * inv_w * 0.5f + 0.5f) * buffer_width;
+			float sy = (0.5f - clip.y * inv_w * 0.5f) * buffer_height;
+
+			min_x = std::min(min_x, sx);
+			max_x = std::max(max_x, sx);
+			min_y = std::min(min_y, sy);
+			max_y = std::max(max_y, sy);
+			min_z = std::min(min_z, clip.z * inv_w);
+		}
+
+		// Off screen boxes are the frustum test's job
+		if (max_x < 0.0f || max_y < 0.0f || min_x >= buffer_width || min_y >= buffer_height)
+			return true;
+
+		int px0 = std::max(0, (int)std::floor(min_x));
+		int px1 = std::min(buffer_width - 1, (int)std::ceil(max_x));
+		int py0 = std::max(0, (int)std::floor(min_y));
+		int py1 = std::min(buffer_height - 1, (int)std::ceil(max_y));
+
+		const __m128 box_z = _mm_set1_ps(min_z);
+
+		for (int ty = py0 / TILE_SIZE; ty <= py1 / TILE_SIZE; ty++)
+		{
+			for (int tx = px0 / TILE_SIZE; tx <= px1 / TILE_SIZE; tx++)
+			{
+				// Every pixel in the tile is closer than the box
+				if (min_z > tile_max_depth[ty * tiles_x + tx])
+					continue;
+
+				int x0 = std::max(px0, tx * TILE_SIZE) & ~3;
+				int x1 = std::min(px1, tx * TILE_SIZE + TILE_SIZE - 1);
+				int y0 = std::max(py0, ty * TILE_SIZE);
+				int y1 = std::min(py1, ty * TILE_SIZE + TILE_SIZE - 1);
+
+				for (int y = y0; y <= y1; y++)
+				{
+					const float* src = &depth[y * buffer_width];
+					for (int x = x0; x <= x1; x += 4)
+					{
+						int mask = _mm_movemask_ps(_mm_cmple_ps(box_z, _mm_loadu_ps(src + x)));
+
+						// Drop lanes left of the box when x0 was rounded down
+						if (x < px0)
+							mask &= ~((1 << (px0 - x)) - 1);
+						// Drop lanes right of the box
+						if (x + 3 > x1)
+							mask &= (1 << (x1 - x + 1)) - 1;
+
+						if (mask)
+							return true;
+					}
+				}
+			}
+		}
+
+		return false;
+	}
+
+	void occlusion_buffer_t::test(const aabb_soa_view_t& boxes, const uint32_t* indices, size_t count, uint8_t* visible, job_system_t* jobs)const
+	{
+		auto test_range = [this, &boxes, indices, visible](size_t first, size_t last)
+		{
+			for (size_t k = first; k < last; k++)
+			{
+				size_t i = indices ? indices[k] : k;
+				visible[i] = test(boxes.get(i)) ? 1 : 0;
+			}
+		};
+
+		if (jobs)
+			jobs->parallel_for(count, TEST_CHUNK_SIZE, test_range);
+		else
+			test_range(0, count);
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "bounds.h"
+#include "job_system.h"
+
+namespace end
+{
+	// Coarse CPU depth buffer for software occlusion culling.
+	//
+	//	Usage per frame:
+	//		begin(view_proj)		clears the buffer and sets the camera
+	//		add_occluder(...)		transforms occluder triangles into screen space
+	//		rasterize(jobs)			writes occluder depth, tile rows are split across the job system
+	//		test(...)				conservative visibility of boxes against the buffer
+	//
+	//	Depth follows D3D conventions: z/w in [0,1], cleared to 1 (far), smaller is closer.
+	//	Matrices are row-vector (p * M) like the rest of the renderer.
+	//	Each 8x8 tile also keeps its farthest depth (one level hierarchy) so most
+	//	boxes are accepted or rejected without touching pixels.
+	class occlusion_buffer_t
+	{
+	public:
+
+		static constexpr int TILE_SIZE = 8;
+
+		// Width and height are rounded up to a multiple of TILE_SIZE
+		occlusion_buffer_t(int width = 256, int height = 144);
+
+		void begin(const float4x4_a& view_proj);
+
+		// Indexed triangle list in world space
+		void add_occluder(const float3* verts, const uint16_t* indices, size_t index_count);
+
+		// The 12 triangles of a box
+		void add_occluder(const aabb_t& box);
+
+		// Boxes straight from a SoA view, indices picks them (nullptr = the first count boxes)
+		void add_occluders(const aabb_soa_view_t& boxes, const uint32_t* indices, size_t count);
+
+		// jobs == nullptr runs on the calling thread
+		void rasterize(job_system_t* jobs = nullptr);
+
+		// Returns false only if the box is fully hidden behind rasterized occluders
+		bool test(const aabb_t& box)const;
+
+		// visible[i] is set to 1 or 0 for each tested box i (indices[k], or k when indices is nullptr),
+		// other entries aren't touched. Boxes are split across the job system.
+		void test(const aabb_soa_view_t& boxes, const uint32_t* indices, size_t count, uint8_t* visible, job_system_t* jobs = nullptr)const;
+
+		int width()const { return buffer_width; }
+		int height()const { return buffer_height; }
+		size_t occluder_triangle_count()const { return triangles.size(); }
+
+		const float* depth_data()const { return depth.data(); }
+
+	private:
+
+		struct screen_triangle_t
+		{
+			float x[3];
+			float y[3];
+			float z[3];
+		};
+
+		void rasterize_tile_rows(int first_row, int last_row);
+
+		int buffer_width;
+		int buffer_height;
+		int tiles_x;
+		int tiles_y;
+
+		float4x4_a view_proj;
+
+		std::vector<float> depth;			// row-major, buffer_width * buffer_height
+		std::vector<float> tile_max_depth;	// farthest depth written in each tile
+		std::vector<screen_triangle_t> triangles;
+	};
+}
@@ -0,0 +1,239 @@
+#include "orientation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <emmintrin.h>
+
+namespace end
+{
+	namespace
+	{
+		constexpr size_t TURN_CHUNK_SIZE = 4096;
+		constexpr float MIN_DISTANCE_SQ = 1e-12f;
+		constexpr float MIN_HORIZONTAL = 1e-6f;
+
+		// Scalar versions, used for single agents and the batch tail //
+
+		void facing_rotation(float dx, float dy, float dz, float out[4])
+		{
+			float len = std::sqrt(dx * dx + dy * dy + dz * dz);
+			float h = std::sqrt(dx * dx + dz * dz);
+
+			// Yaw from the horizontal direction, pitch from the height (positive looks down).
+			// Half angles from the cosines so no trig is needed, straight up/down keeps yaw 0.
+			float cos_yaw = h > MIN_HORIZONTAL ? dz / h : 1.0f;
+			float sin_yaw = h > MIN_HORIZONTAL ? dx / h : 0.0f;
+			float cos_pitch = h / len;
+			float sin_pitch = -dy / len;
+
+			float cy = std::sqrt(std::max(0.0f, (1.0f + cos_yaw) * 0.5f));
+			float sy = std::copysign(std::sqrt(std::max(0.0f, (1.0f - cos_yaw) * 0.5f)), sin_yaw);
+			float cp = std::sqrt(std::max(0.0f, (1.0f + cos_pitch) * 0.5f));
+			float sp = std::copysign(std::sqrt(std::max(0.0f, (1.0f - cos_pitch) * 0.5f)), sin_pitch);
+
+			// Pitch about x, then yaw about y
+			out[0] = cy * sp;
+			out[1] = sy * cp;
+			out[2] = -sy * sp;
+			out[3] = cy * cp;
+		}
+
+		void rotate_toward(float q[4], float t[4], float max_angle)
+		{
+			float d = q[0] * t[0] + q[1] * t[1] + q[2] * t[2] + q[3] * t[3];
+			if (d < 0.0f)
+			{
+				for (int i = 0; i < 4; i++)
+					t[i] = -t[i];
+				d = -d;
+			}
+
+			// Omega is half the angle between the orientations
+			float omega = std::acos(std::min(d, 1.0f));
+			if (2.0f * omega <= max_angle)
+			{
+				for (int i = 0; i < 4; i++)
+					q[i] = t[i];
+				return;
+			}
+
+			float f = max_angle / (2.0f * omega);
+			float s = std::sin(omega);
+			float wa = std::sin((1.0f - f) * omega) / s;
+			float wb = std::sin(f * omega) / s;
+
+			float len_sq = 0.0f;
+			for (int i = 0; i < 4; i++)
+			{
+				q[i] = q[i] * wa + t[i] * wb;
+				len_sq += q[i] * q[i];
+			}
+
+			float k = 1.0f / std::sqrt(len_sq);
+			for (int i = 0; i < 4; i++)
+				q[i] *= k;
+		}
+
+		// SSE //
+
+		inline __m128 select(__m128 mask, __m128 a, __m128 b)
+		{
+			return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+		}
+
+		inline __m128 copysign(__m128 magnitude, __m128 sign)
+		{
+			const __m128 sign_mask = _mm_set1_ps(-0.0f);
+			return _mm_or_ps(_mm_andnot_ps(sign_mask, magnitude), _mm_and_ps(sign_mask, sign));
+		}
+
+		// acos for x in [0, 1], Abramowitz & Stegun 4.4.46 (error ~2e-8)
+		inline __m128 acos_01(__m128 x)
+		{
+			__m128 p = _mm_set1_ps(-0.0012624911f);
+			p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(0.0066700901f));
+			p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(-0.0170881256f));
+			p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(0.0308918810f));
+			p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(-0.0501743046f));
+			p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(0.0889789874f));
+			p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(-0.2145988016f));
+			p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(1.5707963050f));
+			return _mm_mul_ps(p, _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(1.0f), x), _mm_setzero_ps())));
+		}
+
+		// sin for x in [0, pi/2], Taylor series to x^11 (error ~6e-8)
+		inline __m128 sin_0_half_pi(__m128 x)
+		{
+			__m128 x2 = _mm_mul_ps(x, x);
+			__m128 p = _mm_set1_ps(-1.0f / 39916800.0f);
+			p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(1.0f / 362880.0f));
+			p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(-1.0f / 5040.0f));
+			p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(1.0f / 120.0f));
+			p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(-1.0f / 6.0f));
+			p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(1.0f));
+			return _mm_mul_ps(p, x);
+		}
+
+		void turn_toward_sse(const point_soa_view_t& positions, const point_soa_view_t& targets, float max_angle,
+			quat_soa_t& orientations, size_t i)
+		{
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 half = _mm_set1_ps(0.5f);
+
+			__m128 dx = _mm_sub_ps(_mm_loadu_ps(targets.x + i), _mm_loadu_ps(positions.x + i));
+			__m128 dy = _mm_sub_ps(_mm_loadu_ps(targets.y + i), _mm_loadu_ps(positions.y + i));
+			__m128 dz = _mm_sub_ps(_mm_loadu_ps(targets.z + i), _mm_loadu_ps(positions.z + i));
+
+			__m128 h_sq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz));
+			__m128 len_sq = _mm_add_ps(h_sq, _mm_mul_ps(dy, dy));
+			__m128 valid = _mm_cmpgt_ps(len_sq, _mm_set1_ps(MIN_DISTANCE_SQ));
+			__m128 h = _mm_sqrt_ps(h_sq);
+			__m128 len = _mm_sqrt_ps(select(valid, len_sq, one));
+
+			// Facing rotation, see the scalar version
+			__m128 has_yaw = _mm_cmpgt_ps(h, _mm_set1_ps(MIN_HORIZONTAL));
+			__m128 safe_h = select(has_yaw, h, one);
+			__m128 cos_yaw = select(has_yaw, _mm_div_ps(dz, safe_h), one);
+			__m128 sin_yaw = select(has_yaw, _mm_div_ps(dx, safe_h), zero);
+			__m128 cos_pitch = _mm_div_ps(h, len);
+			__m128 sin_pitch = _mm_sub_ps(zero, _mm_div_ps(dy, len));
+
+			__m128 cy = _mm_sqrt_ps(_mm_max_ps(zero, _mm_mul_ps(_mm_add_ps(one, cos_yaw), half)));
+			__m128 sy = copysign(_mm_sqrt_ps(_mm_max_ps(zero, _mm_mul_ps(_mm_sub_ps(one, cos_yaw), half))), sin_yaw);
+			__m128 cp = _mm_sqrt_ps(_mm_max_ps(zero, _mm_mul_ps(_mm_add_ps(one, cos_pitch), half)));
+			__m128 sp = copysign(_mm_sqrt_ps(_mm_max_ps(zero, _mm_mul_ps(_mm_sub_ps(one, cos_pitch), half))), sin_pitch);
+
+			__m128 tx = _mm_mul_ps(cy, sp);
+			__m128 ty = _mm_mul_ps(sy, cp);
+			__m128 tz = _mm_sub_ps(zero, _mm_mul_ps(sy, sp));
+			__m128 tw = _mm_mul_ps(cy, cp);
+
+			__m128 qx = _mm_loadu_ps(orientations.x.data() + i);
+			__m128 qy = _mm_loadu_ps(orientations.y.data() + i);
+			__m128 qz = _mm_loadu_ps(orientations.z.data() + i);
+			__m128 qw = _mm_loadu_ps(orientations.w.data() + i);
+
+			// Rotate toward, shortest way round
+			__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, tx), _mm_mul_ps(qy, ty)), _mm_add_ps(_mm_mul_ps(qz, tz), _mm_mul_ps(qw, tw)));
+			__m128 flip = _mm_and_ps(d, _mm_set1_ps(-0.0f));
+			tx = _mm_xor_ps(tx, flip); ty = _mm_xor_ps(ty, flip); tz = _mm_xor_ps(tz, flip); tw = _mm_xor_ps(tw, flip);
+			d = _mm_min_ps(_mm_xor_ps(d, flip), one);
+
+			__m128 omega = acos_01(d);
+			__m128 angle = _mm_add_ps(omega, omega);
+			__m128 limit = _mm_set1_ps(max_angle);
+			__m128 reached = _mm_cmple_ps(angle, limit);
+
+			__m128 f = _mm_div_ps(limit, select(reached, one, angle));
+			__m128 inv_s = _mm_div_ps(one, select(reached, one, sin_0_half_pi(omega)));
+			__m128 wa = _mm_mul_ps(sin_0_half_pi(_mm_mul_ps(_mm_sub_ps(one, f), omega)), inv_s);
+			__m128 wb = _mm_mul_ps(sin_0_half_pi(_mm_mul_ps(f, omega)), inv_s);
+
+			__m128 rx = _mm_add_ps(_mm_mul_ps(qx, wa), _mm_mul_ps(tx, wb));
+			__m128 ry = _mm_add_ps(_mm_mul_ps(qy, wa), _mm_mul_ps(ty, wb));
+			__m128 rz = _mm_add_ps(_mm_mul_ps(qz, wa), _mm_mul_ps(tz, wb));
+			__m128 rw = _mm_add_ps(_mm_mul_ps(qw, wa), _mm_mul_ps(tw, wb));
+			__m128 k = _mm_div_ps(one, _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)), _mm_add_ps(_mm_mul_ps(rz, rz), _mm_mul_ps(rw, rw)))));
+
+			rx = select(reached, tx, _mm_mul_ps(rx, k));
+			ry = select(reached, ty, _mm_mul_ps(ry, k));
+			rz = select(reached, tz, _mm_mul_ps(rz, k));
+			rw = select(reached, tw, _mm_mul_ps(rw, k));
+
+			// Agents sitting on their target keep their orientation
+			_mm_storeu_ps(orientations.x.data() + i, select(valid, rx, qx));
+			_mm_storeu_ps(orientations.y.data() + i, select(valid, ry, qy));
+			_mm_storeu_ps(orientations.z.data() + i, select(valid, rz, qz));
+			_mm_storeu_ps(orientations.w.data() + i, select(valid, rw, qw));
+		}
+	}
+
+	quat facing_rotation(const float3& dir)
+	{
+		// No direction to face, like turn_toward with target == pos
+		if (dot(dir, dir) <= MIN_DISTANCE_SQ)
+			return quat_identity();
+
+		float q[4];
+		facing_rotation(dir.x, dir.y, dir.z, q);
+		return { simd::load(q) };
+	}
+
+	quat turn_toward(quat q, const float3& pos, const float3& target, float max_angle)
+	{
+		float3 d = target - pos;
+		if (dot(d, d) <= MIN_DISTANCE_SQ)
+			return q;
+
+		float cur[4], goal[4];
+		simd::store(cur, q.r);
+		facing_rotation(d.x, d.y, d.z, goal);
+		rotate_toward(cur, goal, max_angle);
+		return { simd::load(cur) };
+	}
+
+	void turn_toward(const point_soa_view_t& positions, const point_soa_view_t& targets, float max_angle,
+		quat_soa_t& orientations, size_t first, size_t last)
+	{
+		size_t i = first;
+		for (; i + 4 <= last; i += 4)
+			turn_toward_sse(positions, targets, max_angle, orientations, i);
+
+		for (; i < last; i++)
+		{
+			float3 pos = { positions.x[i], positions.y[i], positions.z[i] };
+			float3 target = { targets.x[i], targets.y[i], targets.z[i] };
+			orientations.set(i, turn_toward(orientations.get(i), pos, target, max_angle));
+		}
+	}
+
+	void turn_toward(const point_soa_view_t& positions, const point_soa_view_t& targets, float max_angle,
+		quat_soa_t& orientations, job_system_t& jobs)
+	{
+		jobs.parallel_for(positions.count, TURN_CHUNK_SIZE, [&](size_t first, size_t last)
+		{
+			turn_toward(positions, targets, max_angle, orientations, first, last);
+		});
+	}
+}
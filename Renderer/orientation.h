@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "job_system.h"
+#include "math_types.h"
+#include "simd_math.h"
+
+namespace end
+{
+	// Non-owning structure-of-arrays points
+	struct point_soa_view_t
+	{
+		const float* x = nullptr;
+		const float* y = nullptr;
+		const float* z = nullptr;
+		size_t count = 0;
+	};
+
+	// Structure-of-arrays quaternions, one per agent
+	struct quat_soa_t
+	{
+		std::vector<float> x, y, z, w;
+
+		inline size_t size()const { return x.size(); }
+
+		// New elements start as the identity
+		inline void resize(size_t n)
+		{
+			x.resize(n, 0.0f); y.resize(n, 0.0f); z.resize(n, 0.0f); w.resize(n, 1.0f);
+		}
+
+		inline void set(size_t i, quat q)
+		{
+			float f[4];
+			simd::store(f, q.r);
+			x[i] = f[0]; y[i] = f[1]; z[i] = f[2]; w[i] = f[3];
+		}
+
+		inline quat get(size_t i)const { return { simd::set(x[i], y[i], z[i], w[i]) }; }
+	};
+
+	// Orientation whose +z faces dir with no roll, same yaw/pitch convention as camera_t.
+	// The identity for a (near) zero length dir.
+	quat facing_rotation(const float3& dir);
+
+	// Turns q toward facing target from pos by at most max_angle radians (pi or more snaps to it).
+	// q is returned as is when target == pos.
+	quat turn_toward(quat q, const float3& pos, const float3& target, float max_angle);
+
+	// Batched turn_toward for agents [first, last), 4 at a time with SSE.
+	// Only those elements are written, so disjoint ranges can run on different threads.
+	void turn_toward(const point_soa_view_t& positions, const point_soa_view_t& targets, float max_angle,
+		quat_soa_t& orientations, size_t first, size_t last);
+
+	// All agents, split across the job system
+	void turn_toward(const point_soa_view_t& positions, const point_soa_view_t& targets, float max_angle,
+		quat_soa_t& orientations, job_system_t& jobs);
+}
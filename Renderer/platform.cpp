@@ -0,0 +1,43 @@
+#include "platform.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#endif
+
+namespace end
+{
+#if defined(_WIN32)
+	bool key_down(int key)
+	{
+		return (GetAsyncKeyState(key) & 0x8000) != 0;
+	}
+
+	bool cursor_position(void* window, float2& out)
+	{
+		POINT cursor;
+		if (!GetCursorPos(&cursor))
+			return false;
+		if (window && !ScreenToClient((HWND)window, &cursor))
+			return false;
+
+		out = { (float)cursor.x, (float)cursor.y };
+		return true;
+	}
+#else
+	bool key_down(int)
+	{
+		return false;
+	}
+
+	bool cursor_position(void*, float2&)
+	{
+		return false;
+	}
+#endif
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "math_types.h"
+
+namespace end
+{
+	// Input from the OS, for the frame loop. Headless builds (no Win32) report nothing pressed,
+	// so the same loop runs unattended on build machines.
+
+	// Virtual key codes, letters and digits are their uppercase ASCII like on Win32
+	constexpr int KEY_LBUTTON = 0x01;
+	constexpr int KEY_RBUTTON = 0x02;
+
+	// true while key is held
+	bool key_down(int key);
+
+	// Cursor in window's client area pixels, false if there is no cursor (or window)
+	bool cursor_position(void* window, float2& out);
+}
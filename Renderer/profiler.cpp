@@ -0,0 +1,338 @@
+#include "profiler.h"
+
+#if END_PROFILER
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace end
+{
+	namespace profiler
+	{
+		namespace
+		{
+			constexpr size_t RING_SIZE = 1 << 14; // zones per thread between drains
+			constexpr size_t MAX_ZONES = 1 << 21; // kept for the trace, later ones are dropped
+			constexpr auto DRAIN_PERIOD = std::chrono::milliseconds(5);
+
+			struct zone_t
+			{
+				const char* name;
+				uint64_t begin;
+				uint64_t end;
+			};
+
+			struct collected_zone_t
+			{
+				zone_t zone;
+				uint32_t thread;
+			};
+
+			// Single producer (the owning thread), single consumer (whoever holds drain_lock)
+			struct thread_ring_t
+			{
+				alignas(64) std::atomic<uint64_t> head{ 0 };
+				alignas(64) std::atomic<uint64_t> tail{ 0 };
+				std::atomic<uint64_t> dropped{ 0 };
+				uint32_t index = 0;
+				zone_t zones[RING_SIZE];
+			};
+
+			struct state_t
+			{
+				// Rings of the running threads, names of every thread seen (by index) for the trace
+				std::mutex registry_lock;
+				std::vector<std::unique_ptr<thread_ring_t>> rings;
+				std::vector<std::string> thread_names;
+
+				std::mutex drain_lock;
+				std::vector<collected_zone_t> zones;
+				uint64_t overflow = 0; // also counts the drops of rings that are gone
+
+				std::mutex thread_lock;
+				std::condition_variable wake;
+				std::thread drain_thread;
+				bool running = false;
+
+				// Timestamp to steady_clock, the second pair is taken when writing
+				uint64_t epoch_stamp = now();
+				std::chrono::steady_clock::time_point epoch_time = std::chrono::steady_clock::now();
+			};
+
+			// Never destroyed, threads may still record while statics are torn down
+			state_t& state()
+			{
+				static state_t* s = new state_t;
+				return *s;
+			}
+
+			thread_local thread_ring_t* local_ring = nullptr;
+			thread_local bool thread_exiting = false;
+
+			// Caller holds drain_lock
+			void drain_ring(state_t& s, thread_ring_t* ring)
+			{
+				uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+				uint64_t head = ring->head.load(std::memory_order_acquire);
+				for (; tail != head; tail++)
+				{
+					if (s.zones.size() < MAX_ZONES)
+						s.zones.push_back({ ring->zones[tail % RING_SIZE], ring->index });
+					else
+						s.overflow++;
+				}
+				ring->tail.store(tail, std::memory_order_release);
+			}
+
+			// Drains and frees the ring of an exiting thread, its name stays for the trace
+			void unregister_thread(thread_ring_t* ring)
+			{
+				state_t& s = state();
+				std::lock_guard<std::mutex> drain_guard(s.drain_lock);
+				drain_ring(s, ring);
+				s.overflow += ring->dropped.load(std::memory_order_relaxed);
+
+				std::lock_guard<std::mutex> guard(s.registry_lock);
+				for (auto it = s.rings.begin(); it != s.rings.end(); ++it)
+				{
+					if (it->get() == ring)
+					{
+						s.rings.erase(it);
+						break;
+					}
+				}
+			}
+
+			// Gives the ring back when the thread ends, a ring is ~400KB
+			struct ring_owner_t
+			{
+				thread_ring_t* ring = nullptr;
+
+				~ring_owner_t()
+				{
+					thread_exiting = true;
+					if (ring)
+						unregister_thread(ring);
+					local_ring = nullptr;
+				}
+			};
+
+			thread_ring_t* register_thread()
+			{
+				static thread_local ring_owner_t owner;
+
+				state_t& s = state();
+				std::lock_guard<std::mutex> guard(s.registry_lock);
+				s.rings.emplace_back(new thread_ring_t);
+				thread_ring_t* ring = s.rings.back().get();
+				ring->index = (uint32_t)s.thread_names.size();
+				s.thread_names.push_back("thread " + std::to_string(ring->index));
+
+				owner.ring = ring;
+				return ring;
+			}
+
+			void drain()
+			{
+				state_t& s = state();
+				std::lock_guard<std::mutex> drain_guard(s.drain_lock);
+
+				// Rings are only freed under drain_lock, the pointers stay good until the end
+				std::vector<thread_ring_t*> rings;
+				{
+					std::lock_guard<std::mutex> guard(s.registry_lock);
+					for (auto& r : s.rings)
+						rings.push_back(r.get());
+				}
+
+				for (thread_ring_t* ring : rings)
+					drain_ring(s, ring);
+			}
+
+			void drain_loop()
+			{
+				state_t& s = state();
+				std::unique_lock<std::mutex> lock(s.thread_lock);
+				while (s.running)
+				{
+					s.wake.wait_for(lock, DRAIN_PERIOD);
+					lock.unlock();
+					drain();
+					lock.lock();
+				}
+			}
+
+			// Timestamps per microsecond
+			double stamps_per_us()
+			{
+#if END_PROFILER_TSC
+				state_t& s = state();
+
+				// Need some time since the epoch for a stable ratio
+				auto min_span = std::chrono::milliseconds(20);
+				while (std::chrono::steady_clock::now() - s.epoch_time < min_span)
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+				uint64_t stamp = now();
+				auto time = std::chrono::steady_clock::now();
+				double us = std::chrono::duration<double, std::micro>(time - s.epoch_time).count();
+				return (double)(stamp - s.epoch_stamp) / us;
+#else
+				return (double)std::chrono::steady_clock::period::den / (std::chrono::steady_clock::period::num * 1e6);
+#endif
+			}
+
+			void write_json_string(FILE* file, const char* text)
+			{
+				fputc('"', file);
+				for (const char* c = text; *c; c++)
+				{
+					if (*c == '"' || *c == '\\')
+						fputc('\\', file);
+					if ((unsigned char)*c < 0x20)
+						continue;
+					fputc(*c, file);
+				}
+				fputc('"', file);
+			}
+		}
+
+		void start()
+		{
+			state_t& s = state();
+			std::lock_guard<std::mutex> guard(s.thread_lock);
+			if (s.running)
+				return;
+
+			s.running = true;
+			s.drain_thread = std::thread(drain_loop);
+		}
+
+		void stop()
+		{
+			state_t& s = state();
+			{
+				std::lock_guard<std::mutex> guard(s.thread_lock);
+				if (!s.running)
+					return;
+				s.running = false;
+			}
+			s.wake.notify_all();
+			s.drain_thread.join();
+			drain();
+		}
+
+		void set_thread_name(const char* name)
+		{
+			if (thread_exiting)
+				return;
+			if (!local_ring)
+				local_ring = register_thread();
+
+			std::lock_guard<std::mutex> guard(state().registry_lock);
+			state().thread_names[local_ring->index] = name;
+		}
+
+		void record(const char* name, uint64_t begin, uint64_t end)
+		{
+			thread_ring_t* ring = local_ring;
+			if (!ring)
+			{
+				// Zones from thread_local destructors after the ring went back are dropped
+				if (thread_exiting)
+					return;
+				ring = local_ring = register_thread();
+			}
+
+			uint64_t head = ring->head.load(std::memory_order_relaxed);
+			if (head - ring->tail.load(std::memory_order_acquire) >= RING_SIZE)
+			{
+				ring->dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			ring->zones[head % RING_SIZE] = { name, begin, end };
+			ring->head.store(head + 1, std::memory_order_release);
+		}
+
+		uint64_t dropped_zones()
+		{
+			state_t& s = state();
+
+			// drain_lock keeps an exiting thread from moving its drops into overflow in between
+			std::lock_guard<std::mutex> drain_guard(s.drain_lock);
+			uint64_t dropped = s.overflow;
+
+			std::lock_guard<std::mutex> guard(s.registry_lock);
+			for (auto& r : s.rings)
+				dropped += r->dropped.load(std::memory_order_relaxed);
+			return dropped;
+		}
+
+		bool write_chrome_trace(const char* path)
+		{
+			drain();
+
+			FILE* file = fopen(path, "wb");
+			if (!file)
+				return false;
+
+			state_t& s = state();
+			double scale = 1.0 / stamps_per_us();
+
+			fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+
+			bool first = true;
+			{
+				std::lock_guard<std::mutex> guard(s.registry_lock);
+				for (size_t i = 0; i < s.thread_names.size(); i++)
+				{
+					fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first ? "" : ",\n", (unsigned)i);
+					write_json_string(file, s.thread_names[i].c_str());
+					fputs("}}", file);
+					first = false;
+				}
+			}
+
+			std::lock_guard<std::mutex> guard(s.drain_lock);
+			for (const collected_zone_t& z : s.zones)
+			{
+				// Zones from before the epoch (recorded during static init) clamp to 0
+				double ts = z.zone.begin > s.epoch_stamp ? (double)(z.zone.begin - s.epoch_stamp) * scale : 0.0;
+				double dur = (double)(z.zone.end - z.zone.begin) * scale;
+
+				fprintf(file, "%s{\"name\":", first ? "" : ",\n");
+				write_json_string(file, z.zone.name);
+				fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", z.thread, ts, dur);
+				first = false;
+			}
+
+			fputs("\n]}\n", file);
+			return fclose(file) == 0;
+		}
+	}
+}
+
+#else
+
+namespace end
+{
+	namespace profiler
+	{
+		void start() {}
+		void stop() {}
+		void set_thread_name(const char*) {}
+		bool write_chrome_trace(const char*) { return false; }
+		uint64_t dropped_zones() { return 0; }
+		void record(const char*, uint64_t, uint64_t) {}
+	}
+}
+
+#endif
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+
+// Scoped CPU profiler.
+//
+//	PROFILE_SCOPE("cull") records when the enclosing scope starts and ends into a lock-free
+//	ring owned by the calling thread (one timestamp read each end, no locks after the thread's first zone).
+//	The ring is drained and freed when its thread exits.
+//	A background thread drains the rings, write_chrome_trace saves everything as Chrome trace JSON
+//	(chrome://tracing or ui.perfetto.dev), where nesting shows up from the times per thread.
+//	Zone names must outlive the profiler, use string literals.
+//
+//	Build with END_PROFILER=0 and PROFILE_SCOPE is nothing and the functions are empty.
+#ifndef END_PROFILER
+#define END_PROFILER 1
+#endif
+
+#if END_PROFILER && (defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__))
+#define END_PROFILER_TSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#define END_PROFILER_TSC 0
+#include <chrono>
+#endif
+
+namespace end
+{
+	namespace profiler
+	{
+		// Starts the drain thread, zones recorded before this wait in their rings
+		void start();
+
+		// Stops the drain thread after a last drain, the recorded zones are kept for writing
+		void stop();
+
+		// Name shown for the calling thread's track
+		void set_thread_name(const char* name);
+
+		// Everything drained so far, false if the file couldn't be written
+		bool write_chrome_trace(const char* path);
+
+		// Zones thrown away because a thread's ring was full
+		uint64_t dropped_zones();
+
+		// Raw timestamp, only meaningful to the profiler
+		inline uint64_t now()
+		{
+#if END_PROFILER_TSC
+			return __rdtsc();
+#elif END_PROFILER
+			return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#else
+			return 0;
+#endif
+		}
+
+		void record(const char* name, uint64_t begin, uint64_t end);
+	}
+
+#if END_PROFILER
+	class profile_scope_t
+	{
+	public:
+
+		explicit profile_scope_t(const char* name) : name(name), begin(profiler::now()) {}
+		~profile_scope_t() { profiler::record(name, begin, profiler::now()); }
+
+		profile_scope_t(const profile_scope_t&) = delete;
+		profile_scope_t& operator=(const profile_scope_t&) = delete;
+
+	private:
+
+		const char* name;
+		uint64_t begin;
+	};
+
+#define END_PROFILE_JOIN2(a, b) a##b
+#define END_PROFILE_JOIN(a, b) END_PROFILE_JOIN2(a, b)
+#define PROFILE_SCOPE(name) ::end::profile_scope_t END_PROFILE_JOIN(profile_scope_, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
+}
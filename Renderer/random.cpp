@@ -0,0 +1,205 @@
+#include "random.h"
+
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace end
+{
+	namespace
+	{
+		constexpr float TWO_PI = 6.28318530718f;
+		constexpr float PI = 3.14159265359f;
+
+		// z from u in [0, 1) so directions are uniform over the cap down to cos_max
+		inline float cap_z(float u, float cos_max) { return 1.0f - u * (1.0f - cos_max); }
+
+		// Orthonormal basis around a unit axis (Duff et al. 2017), no branches on the axis
+		struct basis_t
+		{
+			float3 t, b, n;
+		};
+
+		basis_t make_basis(const float3& n)
+		{
+			float sign = std::copysign(1.0f, n.z);
+			float a = -1.0f / (sign + n.z);
+			float b = n.x * n.y * a;
+			return { { 1.0f + sign * n.x * n.x * a, sign * b, -sign * n.x }, { b, sign + n.y * n.y * a, -n.y }, n };
+		}
+
+		float3 to_world(const basis_t& basis, float x, float y, float z)
+		{
+			return basis.t * x + basis.b * y + basis.n * z;
+		}
+
+		// SSE //
+
+		inline __m128i rotl(__m128i x, int k)
+		{
+			return _mm_or_si128(_mm_slli_epi32(x, k), _mm_srli_epi32(x, 32 - k));
+		}
+
+		// [0, 1) in every lane, top 23 bits as the mantissa of [1, 2) minus 1
+		inline __m128 next_floats(__m128i s[4])
+		{
+			__m128i result = _mm_add_epi32(s[0], s[3]);
+			__m128i t = _mm_slli_epi32(s[1], 9);
+			s[2] = _mm_xor_si128(s[2], s[0]);
+			s[3] = _mm_xor_si128(s[3], s[1]);
+			s[1] = _mm_xor_si128(s[1], s[2]);
+			s[0] = _mm_xor_si128(s[0], s[3]);
+			s[2] = _mm_xor_si128(s[2], t);
+			s[3] = rotl(s[3], 11);
+
+			__m128i bits = _mm_or_si128(_mm_srli_epi32(result, 9), _mm_set1_epi32(0x3F800000));
+			return _mm_sub_ps(_mm_castsi128_ps(bits), _mm_set1_ps(1.0f));
+		}
+
+		// sin/cos of u * 2pi - pi for u in [0, 1).
+		// Taylor series on the half angle (within +-pi/2, error ~4e-8) then the double angle formulas.
+		inline void sin_cos_turn(__m128 u, __m128& sin_out, __m128& cos_out)
+		{
+			__m128 h = _mm_sub_ps(_mm_mul_ps(u, _mm_set1_ps(PI)), _mm_set1_ps(PI * 0.5f));
+			__m128 h2 = _mm_mul_ps(h, h);
+
+			__m128 s = _mm_set1_ps(-1.0f / 39916800.0f);
+			s = _mm_add_ps(_mm_mul_ps(s, h2), _mm_set1_ps(1.0f / 362880.0f));
+			s = _mm_add_ps(_mm_mul_ps(s, h2), _mm_set1_ps(-1.0f / 5040.0f));
+			s = _mm_add_ps(_mm_mul_ps(s, h2), _mm_set1_ps(1.0f / 120.0f));
+			s = _mm_add_ps(_mm_mul_ps(s, h2), _mm_set1_ps(-1.0f / 6.0f));
+			s = _mm_add_ps(_mm_mul_ps(s, h2), _mm_set1_ps(1.0f));
+			s = _mm_mul_ps(s, h);
+
+			__m128 c = _mm_set1_ps(1.0f / 479001600.0f);
+			c = _mm_add_ps(_mm_mul_ps(c, h2), _mm_set1_ps(-1.0f / 3628800.0f));
+			c = _mm_add_ps(_mm_mul_ps(c, h2), _mm_set1_ps(1.0f / 40320.0f));
+			c = _mm_add_ps(_mm_mul_ps(c, h2), _mm_set1_ps(-1.0f / 720.0f));
+			c = _mm_add_ps(_mm_mul_ps(c, h2), _mm_set1_ps(1.0f / 24.0f));
+			c = _mm_add_ps(_mm_mul_ps(c, h2), _mm_set1_ps(-0.5f));
+			c = _mm_add_ps(_mm_mul_ps(c, h2), _mm_set1_ps(1.0f));
+
+			sin_out = _mm_mul_ps(_mm_set1_ps(2.0f), _mm_mul_ps(s, c));
+			cos_out = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(2.0f), _mm_mul_ps(s, s)));
+		}
+
+		// Directions with z from u0 over the cap down to cos_max and the angle around from u1
+		inline void cap_directions(__m128 u0, __m128 u1, __m128 cos_max, __m128& x, __m128& y, __m128& z)
+		{
+			const __m128 one = _mm_set1_ps(1.0f);
+			z = _mm_sub_ps(one, _mm_mul_ps(u0, _mm_sub_ps(one, cos_max)));
+			__m128 r = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(one, _mm_mul_ps(z, z)), _mm_setzero_ps()));
+
+			__m128 s, c;
+			sin_cos_turn(u1, s, c);
+			x = _mm_mul_ps(r, c);
+			y = _mm_mul_ps(r, s);
+		}
+
+		// Writes 4 lanes, or the first count of them
+		inline void store_lanes(float* out, __m128 v, size_t count)
+		{
+			if (count >= 4)
+				_mm_storeu_ps(out, v);
+			else
+			{
+				float lanes[4];
+				_mm_storeu_ps(lanes, v);
+				memcpy(out, lanes, count * sizeof(float));
+			}
+		}
+	}
+
+	float3 random_unit_vector(rng_t& rng)
+	{
+		float z = rng.range(-1.0f, 1.0f);
+		float angle = rng.next_float() * TWO_PI;
+		float r = std::sqrt(std::fmax(0.0f, 1.0f - z * z));
+		return { r * std::cos(angle), r * std::sin(angle), z };
+	}
+
+	float3 random_cone_direction(rng_t& rng, const float3& axis, float half_angle)
+	{
+		float z = cap_z(rng.next_float(), std::cos(half_angle));
+		float angle = rng.next_float() * TWO_PI;
+		float r = std::sqrt(std::fmax(0.0f, 1.0f - z * z));
+		return to_world(make_basis(axis), r * std::cos(angle), r * std::sin(angle), z);
+	}
+
+	rng4_t::rng4_t(uint64_t seed, uint64_t stream)
+	{
+		for (uint32_t lane = 0; lane < 4; lane++)
+		{
+			uint32_t words[4];
+			seed_xoshiro128(seed, stream * 4 + lane, words);
+			for (int w = 0; w < 4; w++)
+				s[w][lane] = words[w];
+		}
+	}
+
+	void rng4_t::uniform_floats(float* out, size_t count, float lo, float hi)
+	{
+		__m128i state[4];
+		for (int w = 0; w < 4; w++)
+			state[w] = _mm_load_si128((const __m128i*)s[w]);
+
+		const __m128 offset = _mm_set1_ps(lo);
+		const __m128 scale = _mm_set1_ps(hi - lo);
+		for (size_t i = 0; i < count; i += 4)
+			store_lanes(out + i, _mm_add_ps(offset, _mm_mul_ps(scale, next_floats(state))), count - i);
+
+		for (int w = 0; w < 4; w++)
+			_mm_store_si128((__m128i*)s[w], state[w]);
+	}
+
+	void rng4_t::unit_vectors(float* x, float* y, float* z, size_t count)
+	{
+		__m128i state[4];
+		for (int w = 0; w < 4; w++)
+			state[w] = _mm_load_si128((const __m128i*)s[w]);
+
+		// The whole sphere is a cap down to cos = -1
+		const __m128 cos_max = _mm_set1_ps(-1.0f);
+		for (size_t i = 0; i < count; i += 4)
+		{
+			__m128 u0 = next_floats(state);
+			__m128 u1 = next_floats(state);
+			__m128 vx, vy, vz;
+			cap_directions(u0, u1, cos_max, vx, vy, vz);
+			store_lanes(x + i, vx, count - i);
+			store_lanes(y + i, vy, count - i);
+			store_lanes(z + i, vz, count - i);
+		}
+
+		for (int w = 0; w < 4; w++)
+			_mm_store_si128((__m128i*)s[w], state[w]);
+	}
+
+	void rng4_t::cone_directions(const float3& axis, float half_angle, float* x, float* y, float* z, size_t count)
+	{
+		__m128i state[4];
+		for (int w = 0; w < 4; w++)
+			state[w] = _mm_load_si128((const __m128i*)s[w]);
+
+		const basis_t basis = make_basis(axis);
+		const __m128 cos_max = _mm_set1_ps(std::cos(half_angle));
+		for (size_t i = 0; i < count; i += 4)
+		{
+			__m128 u0 = next_floats(state);
+			__m128 u1 = next_floats(state);
+			__m128 lx, ly, lz;
+			cap_directions(u0, u1, cos_max, lx, ly, lz);
+
+			// Local cap around +z into the axis' basis
+			__m128 wx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(lx, _mm_set1_ps(basis.t.x)), _mm_mul_ps(ly, _mm_set1_ps(basis.b.x))), _mm_mul_ps(lz, _mm_set1_ps(basis.n.x)));
+			__m128 wy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(lx, _mm_set1_ps(basis.t.y)), _mm_mul_ps(ly, _mm_set1_ps(basis.b.y))), _mm_mul_ps(lz, _mm_set1_ps(basis.n.y)));
+			__m128 wz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(lx, _mm_set1_ps(basis.t.z)), _mm_mul_ps(ly, _mm_set1_ps(basis.b.z))), _mm_mul_ps(lz, _mm_set1_ps(basis.n.z)));
+			store_lanes(x + i, wx, count - i);
+			store_lanes(y + i, wy, count - i);
+			store_lanes(z + i, wz, count - i);
+		}
+
+		for (int w = 0; w < 4; w++)
+			_mm_store_si128((__m128i*)s[w], state[w]);
+	}
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "math_types.h"
+
+namespace end
+{
+	// Deterministic random numbers for spawning.
+	//
+	//	xoshiro128+ seeded through splitmix64. A generator is a few words of plain state,
+	//	so give every thread/emitter/job chunk its own, seeded with the same seed and its own stream.
+	//	Seeding by chunk index rather than thread keeps results identical however jobs get scheduled.
+
+	inline uint64_t splitmix64(uint64_t& state)
+	{
+		uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	// Four xoshiro128 state words for seed/stream, never all zero
+	inline void seed_xoshiro128(uint64_t seed, uint64_t stream, uint32_t out[4])
+	{
+		uint64_t mix = stream;
+		uint64_t sm = seed ^ splitmix64(mix);
+		uint64_t a = splitmix64(sm);
+		uint64_t b = splitmix64(sm);
+		out[0] = (uint32_t)a; out[1] = (uint32_t)(a >> 32);
+		out[2] = (uint32_t)b; out[3] = (uint32_t)(b >> 32);
+		if ((out[0] | out[1] | out[2] | out[3]) == 0)
+			out[0] = 1;
+	}
+
+	class rng_t
+	{
+	public:
+
+		explicit rng_t(uint64_t seed = 0, uint64_t stream = 0) { seed_xoshiro128(seed, stream, s); }
+
+		inline uint32_t next_u32()
+		{
+			uint32_t result = s[0] + s[3];
+			uint32_t t = s[1] << 9;
+			s[2] ^= s[0];
+			s[3] ^= s[1];
+			s[1] ^= s[2];
+			s[0] ^= s[3];
+			s[2] ^= t;
+			s[3] = (s[3] << 11) | (s[3] >> 21);
+			return result;
+		}
+
+		// [0, 1), from the top 24 bits (the low bits of xoshiro128+ are weaker)
+		inline float next_float() { return (next_u32() >> 8) * (1.0f / 16777216.0f); }
+
+		// [lo, hi)
+		inline float range(float lo, float hi) { return lo + (hi - lo) * next_float(); }
+
+		// [0, n), multiply shift instead of modulo
+		inline uint32_t next_int(uint32_t n) { return (uint32_t)(((uint64_t)next_u32() * n) >> 32); }
+
+	private:
+
+		uint32_t s[4];
+	};
+
+	// Uniform on the unit sphere
+	float3 random_unit_vector(rng_t& rng);
+
+	// Uniform over the cap of directions within half_angle radians of axis (unit length)
+	float3 random_cone_direction(rng_t& rng, const float3& axis, float half_angle);
+
+	// Four xoshiro128+ generators in SSE lanes (streams stream*4 .. stream*4+3) for batch fills.
+	//
+	//	Counts that aren't a multiple of 4 throw away the rest of the last draw,
+	//	so the same sequence of calls with the same counts always gives the same numbers.
+	class rng4_t
+	{
+	public:
+
+		explicit rng4_t(uint64_t seed = 0, uint64_t stream = 0);
+
+		// out[i] in [lo, hi)
+		void uniform_floats(float* out, size_t count, float lo = 0.0f, float hi = 1.0f);
+
+		// SoA unit vectors, uniform on the sphere
+		void unit_vectors(float* x, float* y, float* z, size_t count);
+
+		// SoA unit vectors within half_angle radians of axis (unit length)
+		void cone_directions(const float3& axis, float half_angle, float* x, float* y, float* z, size_t count);
+
+	private:
+
+		// s[word][lane]
+		alignas(16) uint32_t s[4][4];
+	};
+}
@@ -0,0 +1,337 @@
+#include "raycast.h"
+
+#include <algorithm>
+#include <cmath>
+#include <xmmintrin.h>
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+namespace end
+{
+	namespace
+	{
+		constexpr size_t RAY_CHUNK_SIZE = 64;
+
+		struct ray_setup_t
+		{
+			float3 origin;
+			float3 inv_dir;
+			float t_max;
+			uint8_t parallel_axes; // bit per axis the direction has no (finite inverse) component on
+		};
+
+		ray_setup_t setup_ray(const ray_t& ray)
+		{
+			ray_setup_t setup = { ray.origin, { 1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z }, ray.t_max, 0 };
+
+			// inf * 0 is NaN when the origin is exactly on a slab plane, these axes are tested on the origin instead
+			for (int axis = 0; axis < 3; axis++)
+			{
+				if (!std::isfinite(setup.inv_dir[axis]))
+					setup.parallel_axes |= (uint8_t)(1 << axis);
+			}
+			return setup;
+		}
+
+		// Entry distance (clamped to 0 when starting inside) if the ray hits the box before t_max
+		bool slab_test(const ray_setup_t& ray, const aabb_t& box, float& t_near)
+		{
+			float t_min = 0.0f;
+			float t_max = ray.t_max;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				// Parallel to the slab, always inside it (planes included) or never
+				if (ray.parallel_axes & (1 << axis))
+				{
+					if (ray.origin[axis] < box.min[axis] || ray.origin[axis] > box.max[axis])
+						return false;
+					continue;
+				}
+
+				float t1 = (box.min[axis] - ray.origin[axis]) * ray.inv_dir[axis];
+				float t2 = (box.max[axis] - ray.origin[axis]) * ray.inv_dir[axis];
+				t_min = std::max(t_min, std::min(t1, t2));
+				t_max = std::min(t_max, std::max(t1, t2));
+			}
+
+			t_near = t_min;
+			return t_min <= t_max;
+		}
+
+		// One axis of the batched slab test, entry/exit distances for 4 boxes. On a parallel axis the slab
+		// is all or nothing: (-inf, inf) when the origin is inside it (planes included), empty otherwise.
+		inline void slab_sse(__m128 box_min, __m128 box_max, __m128 origin, __m128 inv_dir, bool parallel, __m128& t_near, __m128& t_far)
+		{
+			if (parallel)
+			{
+				const __m128 inf = _mm_set1_ps(INFINITY), neg_inf = _mm_set1_ps(-INFINITY);
+				__m128 inside = _mm_and_ps(_mm_cmple_ps(box_min, origin), _mm_cmple_ps(origin, box_max));
+				t_near = _mm_or_ps(_mm_and_ps(inside, neg_inf), _mm_andnot_ps(inside, inf));
+				t_far = _mm_or_ps(_mm_and_ps(inside, inf), _mm_andnot_ps(inside, neg_inf));
+				return;
+			}
+
+			__m128 t1 = _mm_mul_ps(_mm_sub_ps(box_min, origin), inv_dir);
+			__m128 t2 = _mm_mul_ps(_mm_sub_ps(box_max, origin), inv_dir);
+			t_near = _mm_min_ps(t1, t2);
+			t_far = _mm_max_ps(t1, t2);
+		}
+
+#ifdef __AVX__
+		inline void slab_avx(__m256 box_min, __m256 box_max, __m256 origin, __m256 inv_dir, bool parallel, __m256& t_near, __m256& t_far)
+		{
+			if (parallel)
+			{
+				const __m256 inf = _mm256_set1_ps(INFINITY), neg_inf = _mm256_set1_ps(-INFINITY);
+				__m256 inside = _mm256_and_ps(_mm256_cmp_ps(box_min, origin, _CMP_LE_OQ), _mm256_cmp_ps(origin, box_max, _CMP_LE_OQ));
+				t_near = _mm256_or_ps(_mm256_and_ps(inside, neg_inf), _mm256_andnot_ps(inside, inf));
+				t_far = _mm256_or_ps(_mm256_and_ps(inside, inf), _mm256_andnot_ps(inside, neg_inf));
+				return;
+			}
+
+			__m256 t1 = _mm256_mul_ps(_mm256_sub_ps(box_min, origin), inv_dir);
+			__m256 t2 = _mm256_mul_ps(_mm256_sub_ps(box_max, origin), inv_dir);
+			t_near = _mm256_min_ps(t1, t2);
+			t_far = _mm256_max_ps(t1, t2);
+		}
+#endif
+
+		// Nearest hit in boxes[first, last), ids maps to the caller's box index (nullptr = identity)
+		void raycast_range(const aabb_soa_view_t& boxes, size_t first, size_t last, const uint32_t* ids, const ray_setup_t& ray, ray_hit_t& hit)
+		{
+			size_t i = first;
+			const bool px = (ray.parallel_axes & 1) != 0, py = (ray.parallel_axes & 2) != 0, pz = (ray.parallel_axes & 4) != 0;
+
+#ifdef __AVX__
+			{
+				const __m256 ox = _mm256_set1_ps(ray.origin.x), oy = _mm256_set1_ps(ray.origin.y), oz = _mm256_set1_ps(ray.origin.z);
+				const __m256 ix = _mm256_set1_ps(ray.inv_dir.x), iy = _mm256_set1_ps(ray.inv_dir.y), iz = _mm256_set1_ps(ray.inv_dir.z);
+
+				for (; i + 8 <= last; i += 8)
+				{
+					__m256 nx, fx, ny, fy, nz, fz;
+					slab_avx(_mm256_loadu_ps(boxes.min_x + i), _mm256_loadu_ps(boxes.max_x + i), ox, ix, px, nx, fx);
+					slab_avx(_mm256_loadu_ps(boxes.min_y + i), _mm256_loadu_ps(boxes.max_y + i), oy, iy, py, ny, fy);
+					slab_avx(_mm256_loadu_ps(boxes.min_z + i), _mm256_loadu_ps(boxes.max_z + i), oz, iz, pz, nz, fz);
+
+					__m256 t_min = _mm256_max_ps(_mm256_max_ps(nx, ny), _mm256_max_ps(nz, _mm256_setzero_ps()));
+					__m256 t_max = _mm256_min_ps(_mm256_min_ps(fx, fy), _mm256_min_ps(fz, _mm256_set1_ps(std::min(ray.t_max, hit.t))));
+
+					int mask = _mm256_movemask_ps(_mm256_cmp_ps(t_min, t_max, _CMP_LE_OQ));
+					if (!mask)
+						continue;
+
+					alignas(32) float t[8];
+					_mm256_store_ps(t, t_min);
+					for (int l = 0; l < 8; l++)
+					{
+						if ((mask & (1 << l)) && t[l] < hit.t)
+							hit = { ids ? ids[i + l] : (uint32_t)(i + l), t[l] };
+					}
+				}
+			}
+#endif
+
+			const __m128 ox = _mm_set1_ps(ray.origin.x), oy = _mm_set1_ps(ray.origin.y), oz = _mm_set1_ps(ray.origin.z);
+			const __m128 ix = _mm_set1_ps(ray.inv_dir.x), iy = _mm_set1_ps(ray.inv_dir.y), iz = _mm_set1_ps(ray.inv_dir.z);
+
+			for (; i + 4 <= last; i += 4)
+			{
+				__m128 nx, fx, ny, fy, nz, fz;
+				slab_sse(_mm_loadu_ps(boxes.min_x + i), _mm_loadu_ps(boxes.max_x + i), ox, ix, px, nx, fx);
+				slab_sse(_mm_loadu_ps(boxes.min_y + i), _mm_loadu_ps(boxes.max_y + i), oy, iy, py, ny, fy);
+				slab_sse(_mm_loadu_ps(boxes.min_z + i), _mm_loadu_ps(boxes.max_z + i), oz, iz, pz, nz, fz);
+
+				// Same as slab_test, the running nearest hit also bounds t_max so farther boxes drop out early
+				__m128 t_min = _mm_max_ps(_mm_max_ps(nx, ny), _mm_max_ps(nz, _mm_setzero_ps()));
+				__m128 t_max = _mm_min_ps(_mm_min_ps(fx, fy), _mm_min_ps(fz, _mm_set1_ps(std::min(ray.t_max, hit.t))));
+
+				int mask = _mm_movemask_ps(_mm_cmple_ps(t_min, t_max));
+				if (!mask)
+					continue;
+
+				alignas(16) float t[4];
+				_mm_store_ps(t, t_min);
+				for (int l = 0; l < 4; l++)
+				{
+					if ((mask & (1 << l)) && t[l] < hit.t)
+						hit = { ids ? ids[i + l] : (uint32_t)(i + l), t[l] };
+				}
+			}
+
+			for (; i < last; i++)
+			{
+				float t;
+				if (slab_test(ray, boxes.get(i), t) && t < hit.t)
+					hit = { ids ? ids[i] : (uint32_t)i, t };
+			}
+		}
+	}
+
+	void raycast(const aabb_soa_view_t& boxes, const ray_t* rays, size_t ray_count, ray_hit_t* hits, job_system_t* jobs)
+	{
+		auto cast = [&](size_t first, size_t last)
+		{
+			for (size_t r = first; r < last; r++)
+			{
+				hits[r] = {};
+				raycast_range(boxes, 0, boxes.count, nullptr, setup_ray(rays[r]), hits[r]);
+			}
+		};
+
+		if (jobs)
+			jobs->parallel_for(ray_count, RAY_CHUNK_SIZE, cast);
+		else
+			cast(0, ray_count);
+	}
+
+	void aabb_bvh_t::build(const aabb_soa_view_t& boxes)
+	{
+		nodes.clear();
+		leaf_boxes.clear();
+		leaf_ids.clear();
+
+		if (!boxes.count)
+			return;
+
+		std::vector<uint32_t> order(boxes.count);
+		std::vector<float3> centers(boxes.count);
+		for (size_t i = 0; i < boxes.count; i++)
+		{
+			order[i] = (uint32_t)i;
+			centers[i] = boxes.get(i).center();
+		}
+
+		nodes.reserve(2 * (boxes.count / LEAF_SIZE) + 1);
+		build_node(boxes, order, centers, 0, (uint32_t)boxes.count);
+
+		// Copy the boxes in leaf order so every leaf is a contiguous run for raycast_range
+		leaf_boxes.resize(boxes.count);
+		leaf_ids = order;
+		for (size_t i = 0; i < order.size(); i++)
+			leaf_boxes.set(i, boxes.get(order[i]));
+	}
+
+	uint32_t aabb_bvh_t::build_node(const aabb_soa_view_t& boxes, std::vector<uint32_t>& order, std::vector<float3>& centers, uint32_t first, uint32_t count)
+	{
+		uint32_t index = (uint32_t)nodes.size();
+		nodes.push_back({});
+
+		aabb_t bounds = boxes.get(order[first]);
+		aabb_t center_bounds = { centers[order[first]], centers[order[first]] };
+		for (uint32_t i = first + 1; i < first + count; i++)
+		{
+			aabb_t box = boxes.get(order[i]);
+			const float3& c = centers[order[i]];
+			for (int axis = 0; axis < 3; axis++)
+			{
+				bounds.min[axis] = std::min(bounds.min[axis], box.min[axis]);
+				bounds.max[axis] = std::max(bounds.max[axis], box.max[axis]);
+				center_bounds.min[axis] = std::min(center_bounds.min[axis], c[axis]);
+				center_bounds.max[axis] = std::max(center_bounds.max[axis], c[axis]);
+			}
+		}
+
+		nodes[index].bounds = bounds;
+
+		if (count <= LEAF_SIZE)
+		{
+			nodes[index].first = first;
+			nodes[index].count = count;
+			return index;
+		}
+
+		// Median split along the widest spread of box centers
+		float3 spread = center_bounds.max - center_bounds.min;
+		int axis = spread.x > spread.y ? (spread.x > spread.z ? 0 : 2) : (spread.y > spread.z ? 1 : 2);
+
+		uint32_t half = count / 2;
+		std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count, [&](uint32_t l, uint32_t r)
+		{
+			return centers[l][axis] < centers[r][axis];
+		});
+
+		build_node(boxes, order, centers, first, half);
+		uint32_t right = build_node(boxes, order, centers, first + half, count - half);
+
+		nodes[index].first = right;
+		nodes[index].count = 0;
+		return index;
+	}
+
+	ray_hit_t aabb_bvh_t::raycast(const ray_t& ray)const
+	{
+		ray_hit_t hit;
+		if (nodes.empty())
+			return hit;
+
+		const ray_setup_t setup = setup_ray(ray);
+		const aabb_soa_view_t view = leaf_boxes.view();
+
+		float t_root;
+		if (!slab_test(setup, nodes[0].bounds, t_root))
+			return hit;
+
+		// Depth is about log2(count / LEAF_SIZE), 64 is plenty
+		struct entry_t { uint32_t node; float t; };
+		entry_t stack[64];
+		int top = 0;
+		stack[top++] = { 0, t_root };
+
+		while (top)
+		{
+			entry_t entry = stack[--top];
+			if (entry.t >= hit.t)
+				continue;
+
+			const node_t& node = nodes[entry.node];
+			if (node.count)
+			{
+				raycast_range(view, node.first, node.first + node.count, leaf_ids.data(), setup, hit);
+				continue;
+			}
+
+			// Visit the nearer child first so its hit can prune the other
+			uint32_t left = entry.node + 1;
+			uint32_t right = node.first;
+			float t_left, t_right;
+			bool hit_left = slab_test(setup, nodes[left].bounds, t_left) && t_left < hit.t;
+			bool hit_right = slab_test(setup, nodes[right].bounds, t_right) && t_right < hit.t;
+
+			if (hit_left && hit_right)
+			{
+				if (t_left <= t_right)
+				{
+					stack[top++] = { right, t_right };
+					stack[top++] = { left, t_left };
+				}
+				else
+				{
+					stack[top++] = { left, t_left };
+					stack[top++] = { right, t_right };
+				}
+			}
+			else if (hit_left)
+				stack[top++] = { left, t_left };
+			else if (hit_right)
+				stack[top++] = { right, t_right };
+		}
+
+		return hit;
+	}
+
+	void aabb_bvh_t::raycast(const ray_t* rays, size_t ray_count, ray_hit_t* hits, job_system_t* jobs)const
+	{
+		auto cast = [&](size_t first, size_t last)
+		{
+			for (size_t r = first; r < last; r++)
+				hits[r] = raycast(rays[r]);
+		};
+
+		if (jobs)
+			jobs->parallel_for(ray_count, RAY_CHUNK_SIZE, cast);
+		else
+			cast(0, ray_count);
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+#include "bounds.h"
+#include "job_system.h"
+
+namespace end
+{
+	constexpr uint32_t RAY_MISS = 0xFFFFFFFFu;
+
+	struct ray_t
+	{
+		float3 origin;
+		float3 direction;			// doesn't need to be normalized, t is in units of it
+		float t_max = FLT_MAX;		// hits past this are ignored (line of sight queries)
+	};
+
+	struct ray_hit_t
+	{
+		uint32_t index = RAY_MISS;	// box index, RAY_MISS if nothing was hit
+		float t = FLT_MAX;			// origin + direction * t is the entry point, 0 if the ray starts inside
+	};
+
+	// Nearest hit of every ray against every box.
+	// Slab test on packets of 8 boxes with AVX (when compiled with it) or 4 with SSE.
+	// Rays are split across the job system if one is given.
+	void raycast(const aabb_soa_view_t& boxes, const ray_t* rays, size_t ray_count, ray_hit_t* hits, job_system_t* jobs = nullptr);
+
+	// Bounding volume hierarchy over a box set for faster ray queries.
+	// Leaves hold up to LEAF_SIZE boxes, copied in leaf order so a leaf is one SIMD packet.
+	// Rebuild when the boxes change.
+	class aabb_bvh_t
+	{
+	public:
+
+		static constexpr uint32_t LEAF_SIZE = 8;
+
+		void build(const aabb_soa_view_t& boxes);
+
+		ray_hit_t raycast(const ray_t& ray)const;
+		void raycast(const ray_t* rays, size_t ray_count, ray_hit_t* hits, job_system_t* jobs = nullptr)const;
+
+		size_t node_count()const { return nodes.size(); }
+
+	private:
+
+		struct node_t
+		{
+			aabb_t bounds;
+			uint32_t first;	// leaf: first box in leaf order, inner: index of the right child (left is the next node)
+			uint32_t count;	// boxes in the leaf, 0 for inner nodes
+		};
+
+		uint32_t build_node(const aabb_soa_view_t& boxes, std::vector<uint32_t>& order, std::vector<float3>& centers, uint32_t first, uint32_t count);
+
+		std::vector<node_t> nodes;
+		aabb_soa_t leaf_boxes;
+		std::vector<uint32_t> leaf_ids; // original box index for each box in leaf order
+	};
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "math_types.h"
+
+#include "shaders/mvp.hlsli"
+#undef cbuffer
+#undef matrix
+
+namespace end
+{
+	class asset_loader_t;
+	class job_system_t;
+
+	// What the frame loop asks of a graphics API, everything behind renderer_t's impl_t goes through here.
+	//
+	//	One frame is begin_frame, any number of update_mvp/draw_* calls, then present.
+	//	Matrices in MVP_t are already transposed for the shaders. Vertex data is only read during the
+	//	call, backends copy what they keep.
+	class render_backend_t
+	{
+	public:
+
+		virtual ~render_backend_t() = default;
+
+		// Once, before the first frame. Files queued on assets are finished by the caller's
+		// assets.wait_all(), their callbacks can use whatever initialize created.
+		// jobs is the renderer's, free for the backend while a frame call runs.
+		virtual void initialize(asset_loader_t& assets, job_system_t& jobs) = 0;
+
+		// Render target size in pixels
+		virtual float width()const = 0;
+		virtual float height()const = 0;
+
+		// Binds and clears the color and depth targets
+		virtual void begin_frame(const float4& clear_color) = 0;
+
+		// The constant buffer the vertex shaders read
+		virtual void update_mvp(const MVP_t& mvp) = 0;
+
+		// 36 vertices generated in the vertex shader (shaders/vs_cube.hlsl), no buffers
+		virtual void draw_cube() = 0;
+
+		// Uploads the line list vertices, then draws them
+		virtual void draw_lines(const colored_vertex* verts, size_t vert_count) = 0;
+
+		virtual void present() = 0;
+	};
+
+	// Accepts everything and renders nothing, see null_backend.h
+	std::unique_ptr<render_backend_t> create_null_backend(uint32_t width = 1280, uint32_t height = 720);
+
+	// Renders on the CPU into memory, see software_backend.h
+	std::unique_ptr<render_backend_t> create_software_backend(uint32_t width = 1280, uint32_t height = 720);
+
+#ifdef FSGD_END_USE_D3D
+	// Device and swapchain for window's client area
+	std::unique_ptr<render_backend_t> create_d3d11_backend(void* window);
+#endif
+}
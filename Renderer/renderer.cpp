@@ -1,15 +1,22 @@
 #include "renderer.h"
 #include "debug_renderer.h"
 
-#ifdef FSGD_END_USE_D3D
-#include "d3d11_renderer_impl.h"
-#endif
+#include "renderer_impl.h"
 
 namespace end
 {
 	renderer_t::renderer_t(native_handle_type window_handle)
 	{
-		p_impl = new impl_t(window_handle, default_view);
+#ifdef FSGD_END_USE_D3D
+		p_impl = new impl_t(create_d3d11_backend(window_handle), window_handle, default_view, {});
+#else
+		p_impl = new impl_t(create_null_backend(), window_handle, default_view, {});
+#endif
+	}
+
+	renderer_t::renderer_t(std::unique_ptr<render_backend_t> backend, const renderer_settings_t& settings)
+	{
+		p_impl = new impl_t(std::move(backend), nullptr, default_view, settings);
 	}
 
 	/*
@@ -32,4 +39,26 @@ namespace end
 		// draw views...
 		// draw views...
 	}
+
+	void renderer_t::draw(const camera_key_t& key, float dt)
+	{
+		p_impl->scripted_key = &key;
+		p_impl->scripted_dt = dt;
+		p_impl->draw_view(default_view);
+		p_impl->scripted_key = nullptr;
+	}
+
+	render_backend_t& renderer_t::backend()
+	{
+		return *p_impl->backend;
+	}
+
+	frame_stats_t* renderer_t::stats()
+	{
+#if FRAME_STATS
+		return &p_impl->frame_stats;
+#else
+		return nullptr;
+#endif
+	}
 }
\ No newline at end of file
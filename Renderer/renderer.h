@@ -6,7 +6,10 @@
 #include "emitter.h"
 #include "XTime.h"
 
+// D3D11 on Windows, the null backend (headless) elsewhere or with FSGD_END_HEADLESS
+#if defined(_WIN32) && !defined(FSGD_END_HEADLESS)
 #define FSGD_END_USE_D3D
+#endif
 
 namespace end
 {
@@ -15,12 +18,28 @@ namespace end
 	// HWND is actually just a typedef/alias for a void*.
 	using native_handle_type = void*;
 
+	class render_backend_t;
+	class frame_stats_t;
+	struct camera_key_t;
+
+	// Scene setup and output files for headless runs, the defaults are what the windowed renderer uses
+	struct renderer_settings_t
+	{
+		const char* scene_path = "scene.bin";	// used in place when it opens and has objects
+		size_t box_count = 0;					// > 0 generates this many boxes instead of loading the scene
+		const char* trace_path = nullptr;		// PROFILE_TRACE builds record zones and write chrome://tracing JSON here on exit
+		const char* frame_stats_path = nullptr;	// FRAME_STATS builds write the per frame CSV here on exit
+	};
+
 	// Interface to the renderer
 	class renderer_t
 	{
 	public:
 
 		renderer_t(native_handle_type window_handle);
+
+		// Draws through backend instead, e.g. create_null_backend() to run the frame loop without a window
+		explicit renderer_t(std::unique_ptr<render_backend_t> backend, const renderer_settings_t& settings = {});
 		//renderer_t(renderer_t&& other);
 
 		~renderer_t();
@@ -32,6 +51,15 @@ namespace end
 		//void update_particls(Emitter em, end::float3 dir, float scalar, end::float4 nColor);
 		void draw();
 
+		// Scripted frame: the cameras are placed from key instead of the keyboard and mouse,
+		// and dt replaces the clock's frame time so runs repeat (see camera_path.h)
+		void draw(const camera_key_t& key, float dt);
+
+		render_backend_t& backend();
+
+		// Frame and stage times, nullptr when built without FRAME_STATS
+		frame_stats_t* stats();
+
 		view_t default_view;
 
 	private:
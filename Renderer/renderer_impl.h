@@ -0,0 +1,1349 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "renderer.h"
+#include "render_backend.h"
+#include "platform.h"
+#include "view.h"
+#include "blob.h"
+#include "bounds.h"
+#include "occlusion.h"
+#include "lod.h"
+#include "cull.h"
+#include "broadphase.h"
+#include "job_system.h"
+#include "raycast.h"
+#include "transform.h"
+#include "geometry.h"
+#include "camera.h"
+#include "camera_path.h"
+#include "orientation.h"
+#include "random.h"
+#include "profiler.h"
+#include "frame_stats.h"
+#include "asset_loader.h"
+#include "scene_file.h"
+#include "world_stream.h"
+
+// NOTE: This header file must *ONLY* be included by renderer.cpp
+// The API calls are in the backends (render_backend.h), everything in here is portable.
+
+#define FREE_POOL_TEST		0
+#define SORTED_POOL_TEST	0
+#define RENDER_PARTICLES	0 // NO WORKING PROPERLY
+#define LOOK_AT				1
+#define TURN_TO				1
+#define MOUSE_CAM			0
+#define FRUSTUM				1
+#define OCCLUSION			1 // needs FRUSTUM, boxes hidden from the frustum camera are drawn grey
+#define CULL_STATS			0 // needs FRUSTUM, prints average plane tests per box once a second
+#define SCREEN_LOD			1 // needs FRUSTUM, drops boxes under a pixel and draws distant ones with less lines
+#define PARALLEL_CULL		1 // needs FRUSTUM, frustum tests boxes in chunks on the job system instead of one at a time
+#define PICKING				1 // needs FRUSTUM, left click casts a ray through the cursor and draws the hit box green
+#define BOX_TRIGGERS		1 // needs FRUSTUM, the frustum camera is a trigger box, drawn boxes it touches are drawn yellow
+#define PROFILE_TRACE		1 // records zones and writes renderer_settings_t::trace_path (chrome://tracing) on exit when it's set, build with END_PROFILER=0 to compile the zones out
+#define FRAME_STATS			1 // prints frame time percentiles once a second and writes renderer_settings_t::frame_stats_path (CSV) on exit when it's set
+#define WORLD_STREAMING		0 // needs FRUSTUM, pages world/cell_X_Z.bin (scene_builder -world) around the camera and culls the loaded cells
+#define CAMERA_RECORD		0 // writes both cameras every frame to camera_path.txt on exit, render_bench replays it
+
+namespace end
+{
+	const float PI = 3.1415926f;
+
+#if LOOK_AT || TURN_TO || FRUSTUM
+	void draw_axi(const float4x4_a& mtx)
+	{
+		// Origin to the tips of the unit axes, x red, y green, z blue
+		static constexpr auto axes = geometry::axes_lines(1.0f);
+		static const float4 colors[3] = { RED, GREEN, BLUE };
+		float4 av[axes.size()];
+		transform_points(axes.data(), axes.size(), mtx, av);
+		for (int a = 0; a < 3; a++)
+			end::debug_renderer::add_line(av[a * 2], av[a * 2 + 1], colors[a], colors[a]);
+	}
+
+	struct AABB
+	{
+		AABB(const float3& _min, const float3& _max) : vmin(_min), vmax(_max) { calc_points(); };
+		float3 vmin, vmax; // where vmin could be (0,0,0) and vmax would be (1,1,1) or vmin = NBL & vmax = FTR
+		float3 center = (vmin + vmax) * 0.5f;
+		float3 FTL, NTR, FBR; // from max
+		float3 FBL, NTL, NBR; // from vmin
+		uint8_t cull_plane = 0; // last frustum plane that rejected the box, it gets tested first next frame
+		void calc_points()
+		{
+			FTL = vmax;
+			FBR = vmax;
+			NTR = vmax;
+			FTL.x = vmin.x;
+			FBR.y = vmin.y;
+			NTR.z = vmin.z;
+
+			FBL = vmin;
+			NTL = vmin;
+			NBR = vmin;
+			NBR.x = vmax.x;
+			NTL.y = vmax.y;
+			FBL.z = vmax.z;
+		}
+	};
+
+	struct Frustum
+	{
+		enum FrstPnts
+		{
+			FTR = 0,
+			FTL,
+			NTL,
+			NTR,
+			FBR,
+			FBL,
+			NBL,
+			NBR
+		};
+
+		enum FrstPlns
+		{
+			Near = 0,
+			Far,
+			Left,
+			Right,
+			Top,
+			Bottom
+		};
+		plane_t planes[6];
+		float3 points[8];
+	};
+
+	int SphereToPlane(const plane_t& plane, const float3& center, float Radius)
+	{
+		float aabb_offset = dot(center, plane.normal);
+		float Offset = aabb_offset - plane.offset;
+		if (Offset > Radius)
+			return 1;
+		else if (Offset < -Radius)
+			return -1;
+		return 0;
+	}
+
+	int AABBtoPlane(const AABB& box, const plane_t& plane)
+	{
+		float3 extents = box.vmax - box.center;
+		float3 abs_norm = { fabsf(plane.normal.x), fabsf(plane.normal.y), fabsf(plane.normal.z) };
+
+		float ProjRadius = dot(extents, abs_norm);
+		return SphereToPlane(plane, box.center, ProjRadius);
+	}
+
+	// Bit i set = fully inside frustum plane i
+	constexpr uint8_t ALL_PLANES_INSIDE = 0x3F;
+
+	// Returns -1 if outside, 1 if fully inside, 0 if intersecting.
+	// parent_inside: planes the parent is fully inside of, the box is inside them too so they're skipped.
+	// inside_out (optional): planes this box is fully inside of, pass it on to its children.
+	// The plane that rejected the box last time is tested first and updated on rejection.
+	int AABBtoFrustum(AABB& box, const Frustum& fstm, uint8_t parent_inside, uint8_t* inside_out, frustum_cull_stats_t* stats = nullptr)
+	{
+		uint8_t inside = parent_inside;
+		int result = 1;
+		int tests = 0;
+
+		for (int n = 0; n < 6; n++)
+		{
+			// cached plane, then the rest in Near, Far, Left, Right, Top, Bottom order
+			int i = (n == 0) ? box.cull_plane : (n <= box.cull_plane ? n - 1 : n);
+
+			if (inside & (1 << i))
+				continue;
+
+			tests++;
+			int side = AABBtoPlane(box, fstm.planes[i]);
+			if (side == -1)
+			{
+				box.cull_plane = (uint8_t)i;
+				result = -1;
+				break;
+			}
+
+			if (side == 1)
+				inside |= (1 << i);
+			else
+				result = 0;
+		}
+
+		if (stats)
+		{
+			stats->objects++;
+			stats->plane_tests += tests;
+		}
+
+		if (inside_out)
+			*inside_out = inside;
+
+		return result;
+	}
+
+	// Returns false if behind, otherwise true
+	bool AABBtoFrustum(AABB& box, const Frustum& fstm, frustum_cull_stats_t* stats = nullptr)
+	{
+		return AABBtoFrustum(box, fstm, 0, nullptr, stats) != -1;
+	}
+#endif
+
+#if LOOK_AT
+	// Orientation + position of the look at object
+	struct oriented_t
+	{
+		quat rotation = quat_identity();
+		float3 position = { 0.0f, 0.0f, 0.0f };
+
+		float4x4_a world()const
+		{
+			float4x4_a rtn = to_float4x4(to_mat4(rotation));
+			rtn[3] = { position.x, position.y, position.z, 1.0f };
+			return rtn;
+		}
+	};
+
+	// Rotates obj's z axis to face tgt's position, position kept
+	void look_at(oriented_t& obj, const float4x4_a& tgt)
+	{
+		obj.rotation = turn_toward(obj.rotation, obj.position, tgt[3].xyz, PI);
+	}
+#endif
+
+#if TURN_TO
+	const float TURN_SPEED = 2.0f; // radians per second
+
+	// Turn to objects in SoA, turned together by the batched turn_toward
+	struct turret_crowd_t
+	{
+		std::vector<float> x, y, z;
+		std::vector<float> target_x, target_y, target_z;
+		quat_soa_t rotations;
+
+		size_t size()const { return x.size(); }
+
+		void add(const float3& position)
+		{
+			x.push_back(position.x);
+			y.push_back(position.y);
+			z.push_back(position.z);
+			target_x.push_back(position.x);
+			target_y.push_back(position.y);
+			target_z.push_back(position.z);
+			rotations.resize(x.size());
+		}
+
+		float4x4_a world(size_t i)const
+		{
+			float4x4_a rtn = to_float4x4(to_mat4(rotations.get(i)));
+			rtn[3] = { x[i], y[i], z[i], 1.0f };
+			return rtn;
+		}
+	};
+
+	// Every turret turns its z axis toward tgt's position by at most TURN_SPEED * dT
+	void turn_to(turret_crowd_t& crowd, const float4x4_a& tgt, float dT, job_system_t& jobs)
+	{
+		std::fill(crowd.target_x.begin(), crowd.target_x.end(), tgt[3].x);
+		std::fill(crowd.target_y.begin(), crowd.target_y.end(), tgt[3].y);
+		std::fill(crowd.target_z.begin(), crowd.target_z.end(), tgt[3].z);
+
+		point_soa_view_t positions = { crowd.x.data(), crowd.y.data(), crowd.z.data(), crowd.size() };
+		point_soa_view_t targets = { crowd.target_x.data(), crowd.target_y.data(), crowd.target_z.data(), crowd.size() };
+		turn_toward(positions, targets, TURN_SPEED * dT, crowd.rotations, jobs);
+	}
+#endif
+
+#if MOUSE_CAM
+	float2 curr_MousePos = { 0.0f, 0.0f };
+	camera_input_t mouse_look_input(float2& cur_pos, float dT)
+	{
+		float2 new_pos = cur_pos;
+		cursor_position(nullptr, new_pos);
+
+		camera_input_t input;
+		input.yaw = (new_pos.x - cur_pos.x) * dT * 0.05f; // How much left/right
+		input.pitch = (new_pos.y - cur_pos.y) * dT * 0.05f; // How much up/down
+		cur_pos = new_pos;
+		return input;
+	}
+#endif
+
+#if FRUSTUM
+	const uint64_t BOX_SEED = 5; // change for a different box layout
+	const size_t MAX_DRAWN_BOXES = 128; // 24 line verts each, the debug line buffer holds 4096
+
+	plane_t calculate_plane(const float3& A, const float3& B, const float3& C)
+	{
+		plane_t rtn;
+		vec3 a = to_vec3(A);
+		vec3 n = normalize(cross(to_vec3(B) - a, to_vec3(C) - a));
+		rtn.normal = to_float3(n);
+		rtn.offset = dot(a, n);
+		return rtn;
+	}
+
+	void render_frustum_ez(Frustum& fstm, const float4x4_a& mtx, float fov, float viewWidth, float viewHeight, float nearDist, float farDist)
+	{
+#pragma region Le_Frustum_Points_&_Lines
+		float3 NCenter = mtx[3].xyz + mtx[2].xyz * nearDist;
+		float3 FCenter = mtx[3].xyz + mtx[2].xyz * farDist;
+
+		float nearHeight = 2 * (tan(fov / 2) * nearDist);
+		float farHeight = 2 * (tan(fov / 2) * farDist);
+		float nearWidth = nearHeight * (viewWidth / viewHeight);
+		float farWidth = farHeight * (viewWidth / viewHeight);
+
+		// geometry::unit_frustum_corners order to the Frustum's points
+		static constexpr Frustum::FrstPnts unit_corner_points[8] = {
+			Frustum::NBL, Frustum::NBR, Frustum::NTL, Frustum::NTR,
+			Frustum::FBL, Frustum::FBR, Frustum::FTL, Frustum::FTR };
+
+		// Corners in camera space, moved to world space in one batch
+		float3 corners[8];
+		for (int k = 0; k < 8; k++)
+		{
+			const float3& u = geometry::unit_frustum_corners[k];
+			bool far_corner = u.z > 0.0f;
+			float half_width = (far_corner ? farWidth : nearWidth) * 0.5f;
+			float half_height = (far_corner ? farHeight : nearHeight) * 0.5f;
+			corners[unit_corner_points[k]] = { u.x * half_width, u.y * half_height, far_corner ? farDist : nearDist };
+		}
+
+		float4 world_corners[8];
+		transform_points(corners, 8, mtx, world_corners);
+		for (int i = 0; i < 8; i++)
+			fstm.points[i] = world_corners[i].xyz;
+
+		// The 12 edges, corners one bit apart
+		for (int k = 0; k < 8; k++)
+		{
+			for (int bit = 1; bit < 8; bit <<= 1)
+			{
+				if (!(k & bit))
+					end::debug_renderer::add_line(fstm.points[unit_corner_points[k]], fstm.points[unit_corner_points[k | bit]], WHITE);
+			}
+		}
+#pragma endregion
+
+#pragma region Le_Frustum_Planes_&_Normals
+		/*frustum normals were off because offset was being stored in w
+		 fix: plane_t saves normal and offset seperately*/
+		fstm.planes[fstm.Near] = calculate_plane(fstm.points[fstm.NTR], fstm.points[fstm.NTL], fstm.points[fstm.NBL]); // Near
+		fstm.planes[fstm.Far] = calculate_plane(fstm.points[fstm.FTL], fstm.points[fstm.FTR], fstm.points[fstm.FBL]); // Far
+		fstm.planes[fstm.Top] = calculate_plane(fstm.points[fstm.FTL], fstm.points[fstm.NTL], fstm.points[fstm.FTR]); // Top
+		fstm.planes[fstm.Bottom] = calculate_plane(fstm.points[fstm.FBL], fstm.points[fstm.FBR], fstm.points[fstm.NBL]); // Bottom
+		fstm.planes[fstm.Left] = calculate_plane(fstm.points[fstm.NTL], fstm.points[fstm.FTL], fstm.points[fstm.NBL]); // Left
+		fstm.planes[fstm.Right] = calculate_plane(fstm.points[fstm.FTR], fstm.points[fstm.NTR], fstm.points[fstm.FBR]); // Right
+
+		float3 LCenter = (fstm.points[fstm.NTL] + fstm.points[fstm.NBL] + fstm.points[fstm.FTL] + fstm.points[fstm.FBL]) * 0.25f;
+		float3 RCenter = (fstm.points[fstm.NTR] + fstm.points[fstm.NBR] + fstm.points[fstm.FTR] + fstm.points[fstm.FBR]) * 0.25f;
+		float3 TCenter = (fstm.points[fstm.NTL] + fstm.points[fstm.NTR] + fstm.points[fstm.FTL] + fstm.points[fstm.FTR]) * 0.25f;
+		float3 BCenter = (fstm.points[fstm.NBL] + fstm.points[fstm.NBR] + fstm.points[fstm.FBL] + fstm.points[fstm.FBR]) * 0.25f;
+
+		end::debug_renderer::add_line(NCenter, fstm.planes[fstm.Near].normal + NCenter, { .75f, 0.0f,.5f, 1.0f }, { 1.0f,1.0f,1.0f,1.0f });
+		end::debug_renderer::add_line(FCenter, fstm.planes[fstm.Far].normal + FCenter, { .75f, 0.0f,.5f, 1.0f }, { 1.0f,1.0f,1.0f,1.0f });
+		end::debug_renderer::add_line(LCenter, fstm.planes[fstm.Left].normal + LCenter, { .75f, 0.0f,.5f, 1.0f }, { 1.0f,1.0f,1.0f,1.0f });
+		end::debug_renderer::add_line(RCenter, fstm.planes[fstm.Right].normal + RCenter, { .75f, 0.0f,.5f, 1.0f }, { 1.0f,1.0f,1.0f,1.0f });
+		end::debug_renderer::add_line(TCenter, fstm.planes[fstm.Top].normal + TCenter, { .75f, 0.0f,.5f, 1.0f }, { 1.0f,1.0f,1.0f,1.0f });
+		end::debug_renderer::add_line(BCenter, fstm.planes[fstm.Bottom].normal + BCenter, { .75f, 0.0f,.5f, 1.0f }, { 1.0f,1.0f,1.0f,1.0f });
+
+#pragma endregion
+	}
+
+	// Per box results of the culling stages, render_aabb colors and skips boxes by them.
+	// All optional, arrays are indexed like the box vector.
+	struct box_cull_results_t
+	{
+		const uint8_t* in_frustum = nullptr;	// frustum result from a batched pass, tested one by one otherwise
+		const uint8_t* visible = nullptr;		// occlusion result, 0 = hidden behind an occluder
+		const uint8_t* lods = nullptr;			// screen size LOD, LOD_CULLED boxes are skipped
+		const uint8_t* touched = nullptr;		// 1 = overlaps the frustum camera's trigger box
+		uint8_t parent_inside = 0;				// frustum planes a box enclosing all of them is fully inside of
+		uint32_t picked = RAY_MISS;				// box under the cursor
+		frustum_cull_stats_t* stats = nullptr;
+	};
+
+	void render_aabb(const std::vector<AABB*>& box, const Frustum& fstm, const box_cull_results_t& results = {})
+	{
+		for (int i = 0; i < box.size(); i++)
+		{
+			const uint8_t* lods = results.lods;
+			if (lods && lods[i] == LOD_CULLED)
+				continue;
+
+			bool in_frustum = results.in_frustum ? results.in_frustum[i] != 0 :
+				AABBtoFrustum(*box[i], fstm, results.parent_inside, nullptr, results.stats) != -1;
+
+			float4 color;
+			if ((uint32_t)i == results.picked)
+				color = GREEN;
+			else if (results.touched && results.touched[i])
+				color = YELLOW;
+			else if (!in_frustum)
+				color = BLUE;
+			else if (results.visible && !results.visible[i])
+				color = GREY;
+			else
+				color = RED;
+
+			// Distant boxes only get their diagonal
+			if (lods && lods[i] > 0)
+			{
+				end::debug_renderer::add_line(box[i]->vmin, box[i]->vmax, color);
+				continue;
+			}
+
+			end::debug_renderer::add_line(box[i]->vmax, box[i]->FTL, color);
+			end::debug_renderer::add_line(box[i]->vmax, box[i]->FBR, color);
+			end::debug_renderer::add_line(box[i]->vmax, box[i]->NTR, color);
+			end::debug_renderer::add_line(box[i]->vmin, box[i]->FBL, color);
+			end::debug_renderer::add_line(box[i]->vmin, box[i]->NTL, color);
+			end::debug_renderer::add_line(box[i]->vmin, box[i]->NBR, color);
+			end::debug_renderer::add_line(box[i]->NTL, box[i]->FTL, color);
+			end::debug_renderer::add_line(box[i]->FTL, box[i]->FBL, color);
+			end::debug_renderer::add_line(box[i]->NTR, box[i]->NBR, color);
+			end::debug_renderer::add_line(box[i]->NBR, box[i]->FBR, color);
+			end::debug_renderer::add_line(box[i]->NTL, box[i]->NTR, color);
+			end::debug_renderer::add_line(box[i]->FBL, box[i]->FBR, color);
+		}
+	}
+#endif
+	// Keys that drive one camera_t, see read_camera_input
+	struct camera_keys_t
+	{
+		int forward, back, right, left, down, up;
+		int yaw_left, yaw_right, pitch_up, pitch_down;
+	};
+
+	const camera_keys_t WASD_KEYS = { 'W', 'S', 'D', 'A', 'C', 'X', 'Q', 'E', 'R', 'F' };
+	const camera_keys_t IJKL_KEYS = { 'I', 'K', 'L', 'J', 'N', 'M', 'U', 'O', 'Y', 'H' };
+
+	// Held keys as one frame of input, applied by the camera in a single update
+	camera_input_t read_camera_input(const camera_keys_t& keys, float dT)
+	{
+		const float move = dT * 10.0f;
+		const float turn = dT;
+
+		camera_input_t input;
+		if (key_down(keys.forward))
+			input.move.z += move;
+		if (key_down(keys.back))
+			input.move.z -= move;
+		if (key_down(keys.right))
+			input.move.x += move;
+		if (key_down(keys.left))
+			input.move.x -= move;
+		if (key_down(keys.down))
+			input.move.y -= move;
+		if (key_down(keys.up))
+			input.move.y += move;
+
+		if (key_down(keys.yaw_left))
+			input.yaw -= turn;
+		if (key_down(keys.yaw_right))
+			input.yaw += turn;
+		if (key_down(keys.pitch_up))
+			input.pitch -= turn;
+		if (key_down(keys.pitch_down))
+			input.pitch += turn;
+
+		return input;
+	}
+
+#if CAMERA_RECORD
+	camera_pose_t pose_of(const camera_t& camera)
+	{
+		return { camera.position(), camera.yaw(), camera.pitch() };
+	}
+#endif
+
+	struct renderer_t::impl_t
+	{
+// The graphics API, everything it needs lives in there
+		std::unique_ptr<render_backend_t> backend;
+		native_handle_type window; // cursor position for picking, nullptr when headless
+
+#if FREE_POOL_TEST
+		pool_t<Particle, 100> fp_test;
+#endif
+
+#if SORTED_POOL_TEST
+		sorted_pool_t<Particle, 100> sp_test;
+#endif
+
+#if RENDER_PARTICLES
+		///////////// PARTICLES /////////////////////
+		Emitter emitters[NUM_OF_EMITTERS];
+		pool_t<Particle, numOfParticles* NUM_OF_EMITTERS> particles;
+		/////////////////////////////////////////////
+#endif
+
+#if LOOK_AT
+		oriented_t look_at_obj;
+#endif
+
+#if TURN_TO
+		turret_crowd_t turrets;
+#endif
+
+#if FRUSTUM
+		Frustum frustum;
+		float4x4_a frst_mtx = to_float4x4(mat4_identity());
+		std::vector<AABB*> boxes; // debug drawn boxes, the first MAX_DRAWN_BOXES of box_view
+		scene_file_t scene;
+		aabb_soa_t box_soa; // generated boxes when there is no scene file
+		aabb_soa_view_t box_view; // every box, what the batched stages read (scene mapping or box_soa)
+		AABB* box_group = nullptr; // encloses all boxes, its inside planes are skipped for each box
+		frustum_cull_stats_t cull_stats;
+		double cull_stats_time = 0.0;
+#endif
+
+#if SCREEN_LOD
+		lod_settings_t lod_settings;
+		std::vector<uint32_t> lod_indices;
+		std::vector<uint8_t> lod_kept;
+		std::vector<uint8_t> box_lod; // per box, LOD_CULLED if too small
+#endif
+
+#if OCCLUSION
+		occlusion_buffer_t occlusion;
+		std::vector<uint32_t> occluder_indices;
+		std::vector<uint8_t> box_visible;
+#endif
+
+#if PARALLEL_CULL
+		frustum_culler_t culler;
+		std::vector<uint32_t> frustum_indices;
+		std::vector<uint8_t> box_in_frustum;
+#endif
+
+#if PICKING
+		aabb_bvh_t box_bvh;
+		ray_hit_t pick_hit;
+#endif
+
+#if BOX_TRIGGERS
+		sap_broadphase_t triggers;	// handles 0..boxes.size() - 1 are the drawn boxes, then the frustum camera
+		uint32_t camera_trigger = 0;
+		std::vector<uint8_t> box_touched;
+#endif
+		job_system_t jobs;
+		asset_loader_t assets{ 2, &jobs }; // compressed archive entries decompress on the job system
+
+#if WORLD_STREAMING
+		world_streamer_t world;
+		std::vector<size_t> cell_visible; // per ready cell, objects inside the frustum
+		std::vector<uint32_t> cell_indices;
+		double world_stats_time = 0.0;
+#endif
+		XTime timer;
+
+#if FRAME_STATS
+		frame_stats_t frame_stats{ 1.0 / 30.0 }; // a frame over 33ms is a hitch at 60Hz
+		size_t cull_stage = frame_stats.add_series("cull", 0.002);
+		size_t occlusion_stage = frame_stats.add_series("occlusion", 0.002);
+		size_t lod_stage = frame_stats.add_series("lod", 0.001);
+		size_t lines_stage = frame_stats.add_series("draw lines", 0.002);
+		size_t present_stage = frame_stats.add_series("present", 0.004);
+		double frame_stats_time = 0.0;
+		std::string frame_stats_path; // empty = no CSV
+#endif
+
+#if PROFILE_TRACE
+		std::string trace_path; // empty = the profiler isn't started
+#endif
+
+		camera_t view_camera;		// drives default_view
+		camera_t frustum_camera;	// the debug frustum (frst_mtx)
+
+		// Set for the frames of renderer_t::draw(key, dt), no keyboard or mouse then
+		const camera_key_t* scripted_key = nullptr;
+		float scripted_dt = 0.0f;
+
+#if CAMERA_RECORD
+		camera_path_t recorded_path;
+#endif
+
+		// Constructor for renderer implementation
+		// 
+		impl_t(std::unique_ptr<render_backend_t> render_backend, native_handle_type window_handle, view_t& default_view, const renderer_settings_t& settings)
+			: backend(std::move(render_backend)), window(window_handle)
+		{
+#if PROFILE_TRACE
+			if (settings.trace_path)
+			{
+				trace_path = settings.trace_path;
+				profiler::set_thread_name("main");
+				profiler::start();
+			}
+#endif
+#if FRAME_STATS
+			if (settings.frame_stats_path)
+				frame_stats_path = settings.frame_stats_path;
+#endif
+
+			// Shader files are read while the backend sets up its device,
+			// from shaders.pak when it's there (see asset_packer) and loose .cso files otherwise
+			assets.mount("shaders.pak");
+			backend->initialize(assets, jobs);
+
+			// Runs the shader callbacks here on the main thread
+			assets.wait_all();
+
+			float aspect = backend->width() / backend->height();
+
+			view_camera.look_at({ 0.0f, 15.0f, -15.0f }, { 0.0f, 0.0f, 0.0f });
+
+			default_view.view_mat = view_camera.world();
+			default_view.proj_mat = to_float4x4(mat4_perspective_fov_lh(PI / 4.0f, aspect, 0.01f, 100.0f));
+
+#if MOUSE_CAM
+			cursor_position(nullptr, curr_MousePos);
+#endif
+
+#if RENDER_PARTICLES
+			/////////////////// PARTICLE CREATION ///////////////////
+			create_emitters(0, W_ORIGIN, WHITE);
+			create_emitters(1, { 10,0,0 }, WHITE);
+			create_emitters(2, { -10,0,0 }, WHITE);
+			create_particles(/*NUM_OF_EMITTERS, 0,*/ W_UP, WHITE);
+			/////////////////////////////////////////////////////////
+#endif
+
+#if LOOK_AT 
+			look_at_obj.position = { -5.0f, 5.0f, 2.0f };
+#endif
+
+#if TURN_TO
+			// 4 x 4, 2 units apart from (5, 5, 2)
+			for (int r = 0; r < 4; r++)
+			{
+				for (int c = 0; c < 4; c++)
+					turrets.add({ 5.0f + 2.0f * c, 5.0f, 2.0f + 2.0f * r });
+			}
+#endif
+
+#if FRUSTUM
+			// scene.bin (see scene_builder) is used in place from its mapping,
+			// otherwise a few generated boxes (settings.box_count for benchmarks), same layout every run.
+			// The group box covers every box the cull reads, not just the drawn ones; the scene file stores it.
+			aabb_t group_bounds;
+			if (settings.box_count == 0 && scene.open(settings.scene_path) && scene.object_count() > 0)
+			{
+				box_view = scene.bounds();
+				group_bounds = scene.scene_bounds();
+			}
+			else
+			{
+				scene.close();
+				size_t box_count = settings.box_count > 0 ? settings.box_count : 4;
+
+				// Lattice 2 units apart, 5 wide for the default 4 and growing with the count
+				uint32_t cells = std::max(5u, 2 * (uint32_t)std::ceil(std::cbrt((double)box_count)));
+				rng_t box_rng(BOX_SEED);
+				vec3 group_min, group_max;
+				for (size_t i = 0; i < box_count; i++)
+				{
+					float minX = box_rng.next_int(cells) * 2.0f;
+					float minY = box_rng.next_int(cells) * 2.0f;
+					float minZ = box_rng.next_int(cells) * 2.0f;
+					aabb_t box = { { minX, minY, minZ }, { minX + 1, minY + 1, minZ + 1 } };
+					box_soa.push_back(box);
+
+					group_min = i == 0 ? to_vec3(box.min) : min(group_min, to_vec3(box.min));
+					group_max = i == 0 ? to_vec3(box.max) : max(group_max, to_vec3(box.max));
+				}
+				box_view = box_soa.view();
+				group_bounds = { to_float3(group_min), to_float3(group_max) };
+			}
+
+			for (size_t i = 0; i < box_view.count && i < MAX_DRAWN_BOXES; i++)
+			{
+				aabb_t b = box_view.get(i);
+				boxes.push_back(new AABB(b.min, b.max));
+			}
+
+			box_group = new AABB(group_bounds.min, group_bounds.max);
+#endif
+
+#if PICKING
+			box_bvh.build(box_view);
+#endif
+
+#if BOX_TRIGGERS
+			for (AABB* b : boxes)
+				triggers.add({ b->vmin, b->vmax });
+			camera_trigger = triggers.add(camera_trigger_bounds());
+			box_touched.assign(boxes.size(), 0);
+#endif
+			timer.Restart();
+		}
+
+		bool LookAt = false;
+		void draw_view(view_t& view)
+		{
+			PROFILE_SCOPE("draw_view");
+
+			// TIMER Update //
+			timer.Signal();
+			float deltaT = scripted_key ? scripted_dt : timer.Delta();
+			bool live_input = scripted_key == nullptr;
+			/////////////////
+
+			// Device objects for any loads that finished since last frame
+			assets.update();
+
+#if FRAME_STATS
+			report_frame_stats();
+#endif
+
+			// Fill Color
+			const float4 black{ 0.0f, 0.0f, 0.0f, 1.0f };
+
+			backend->begin_frame(black);
+
+			// CLEARING DEBUG LINES // 
+			end::debug_renderer::clear_lines();
+			//////////////////////////
+
+			update_mvp(view);
+
+			// The Cube
+			//backend->draw_cube();
+
+			// Draw Debug Line Stuff //
+			draw_debug_grid(view);
+			///////////////////////////
+
+#if FREE_POOL_TEST
+			//end::debug_renderer::clear_lines();
+			f_create_test_particles();
+			f_update_test_particles(deltaT);
+#endif
+
+#if SORTED_POOL_TEST
+			//end::debug_renderer::clear_lines();
+			create_test_particles();
+			update_test_particles(deltaT);
+#endif
+
+#if RENDER_PARTICLES
+			//////////////////// Particles ////////////////////
+			{
+				PROFILE_SCOPE("particles");
+				create_particles(/*NUM_OF_EMITTERS, 0,*/ W_UP, WHITE);
+				update_particles(0, deltaT, { 1.0f,0.0f,0.0f,1.0f });
+
+				//create_particles(/*NUM_OF_EMITTERS, 1,*/ W_UP, WHITE);
+				update_particles(1, deltaT, { 0.0f,1.0f,0.0f,1.0f });
+
+				//create_particles(/*NUM_OF_EMITTERS, 2,*/ W_UP, WHITE);
+				update_particles(2, deltaT, { 0.0f,0.0f,1.0f,1.0f });
+			}
+			//////////////////////////////////////////////////
+#endif
+
+#if LOOK_AT
+			if (live_input && key_down('1'))
+				LookAt = true;
+			if (live_input && key_down('2'))
+				LookAt = false;
+			if (LookAt)
+				look_at(look_at_obj, frst_mtx);
+
+			draw_axi(look_at_obj.world());
+#endif
+
+#if TURN_TO
+
+
+			if (live_input && key_down('1'))
+				LookAt = true;
+			if (live_input && key_down('2'))
+				LookAt = false;
+			if (LookAt)
+				turn_to(turrets, frst_mtx, deltaT, jobs);
+
+			for (size_t i = 0; i < turrets.size(); i++)
+				draw_axi(turrets.world(i));
+#endif
+
+#if MOUSE_CAM
+			if (live_input && key_down(KEY_RBUTTON))
+				view_camera.add_input(mouse_look_input(curr_MousePos, deltaT));
+			else cursor_position(nullptr, curr_MousePos);
+#endif
+
+			if (live_input)
+			{
+#if FRUSTUM
+				view_camera.add_input(read_camera_input(WASD_KEYS, deltaT));
+				frustum_camera.add_input(read_camera_input(IJKL_KEYS, deltaT));
+				frustum_camera.update();
+#endif
+			}
+			else
+			{
+				view_camera.set_pose(scripted_key->view.position, scripted_key->view.yaw, scripted_key->view.pitch);
+				frustum_camera.set_pose(scripted_key->frustum.position, scripted_key->frustum.yaw, scripted_key->frustum.pitch);
+			}
+#if FRUSTUM
+			frst_mtx = frustum_camera.world();
+#endif
+			// All of this frame's input is in, compose the matrices once
+			view_camera.update();
+			view.view_mat = view_camera.world();
+
+#if CAMERA_RECORD
+			if (live_input)
+				recorded_path.add({ (float)timer.TotalTime(), pose_of(view_camera), pose_of(frustum_camera) });
+#endif
+
+#if FRUSTUM
+			render_frustum_ez(frustum, frst_mtx, (60.0f * (PI / 180.0f)), 1280, 720, 1.0f, 10.0f);
+			draw_axi(frst_mtx);
+
+			box_cull_results_t results;
+			results.stats = &cull_stats;
+
+#if PARALLEL_CULL
+			cull_boxes_parallel();
+			results.in_frustum = box_in_frustum.data();
+#else
+			// Parent test, the boxes don't need the planes the group is fully inside of
+			AABBtoFrustum(*box_group, frustum, 0, &results.parent_inside, &cull_stats);
+#endif
+#if OCCLUSION
+			cull_occluded_boxes();
+			results.visible = box_visible.data();
+#endif
+#if SCREEN_LOD
+			select_box_lods(view);
+			results.lods = box_lod.data();
+#endif
+#if PICKING
+			if (live_input && key_down(KEY_LBUTTON))
+				pick_box(view);
+			results.picked = pick_hit.index;
+#endif
+#if BOX_TRIGGERS
+			update_triggers();
+			results.touched = box_touched.data();
+#endif
+			render_aabb(boxes, frustum, results);
+
+#if WORLD_STREAMING
+			stream_world(deltaT);
+#endif
+
+#if CULL_STATS
+			if (timer.TotalTime() - cull_stats_time >= 1.0)
+			{
+				printf("frustum: %.2f plane tests per box\n", cull_stats.average_plane_tests());
+				cull_stats.reset();
+				cull_stats_time = timer.TotalTime();
+			}
+#endif
+#endif
+			draw_debug_lines(view);
+			{
+				PROFILE_SCOPE("present");
+#if FRAME_STATS
+				stage_timer_t stage(frame_stats, present_stage);
+#endif
+				backend->present();
+			}
+		}
+
+#if FRAME_STATS
+		void report_frame_stats()
+		{
+			// The first delta is all of startup
+			if (timer.TotalTime() > timer.Delta())
+				frame_stats.record_frame(timer.Delta());
+
+			// Scripted runs report their own numbers
+			if (!scripted_key && timer.TotalTime() - frame_stats_time >= 1.0)
+			{
+				frame_stats_snapshot_t s = frame_stats.snapshot(frame_stats_t::FRAME);
+				printf("frame: p50 %.2fms p95 %.2fms p99 %.2fms max %.2fms, %llu hitches\n",
+					s.p50 * 1e3, s.p95 * 1e3, s.p99 * 1e3, s.max * 1e3, (unsigned long long)s.hitches);
+				frame_stats_time = timer.TotalTime();
+			}
+		}
+#endif
+
+#if OCCLUSION
+		void cull_occluded_boxes()
+		{
+			PROFILE_SCOPE("occlusion");
+#if FRAME_STATS
+			stage_timer_t stage(frame_stats, occlusion_stage);
+#endif
+
+			// Same camera the debug frustum is built from
+			mat4 frst_proj = mat4_perspective_fov_lh(60.0f * (PI / 180.0f), 1280.0f / 720.0f, 1.0f, 10.0f);
+			float4x4_a view_proj = to_float4x4(to_mat4(frustum_camera.view()) * frst_proj);
+
+			// Boxes that aren't tested (outside the frustum) stay visible, render_aabb draws them blue anyway
+			box_visible.assign(box_view.count, 1);
+
+#if PARALLEL_CULL
+			const uint32_t* candidates = frustum_indices.data();
+			size_t candidate_count = frustum_indices.size();
+#else
+			const uint32_t* candidates = nullptr;
+			size_t candidate_count = box_view.count;
+#endif
+
+			// Occluders are the candidates the scene flags as SCENE_OBJECT_OCCLUDER,
+			// boxes out of the frustum can't cover anything in it. Generated boxes have no flags and all occlude.
+			const uint32_t* flags = scene.is_open() ? scene.flags() : nullptr;
+			occluder_indices.clear();
+			for (size_t k = 0; k < candidate_count; k++)
+			{
+				uint32_t i = candidates ? candidates[k] : (uint32_t)k;
+				if (!flags || (flags[i] & SCENE_OBJECT_OCCLUDER))
+					occluder_indices.push_back(i);
+			}
+
+			occlusion.begin(view_proj);
+			occlusion.add_occluders(box_view, occluder_indices.data(), occluder_indices.size());
+			occlusion.rasterize(&jobs);
+			occlusion.test(box_view, candidates, candidate_count, box_visible.data(), &jobs);
+		}
+#endif
+
+#if PARALLEL_CULL
+		void cull_boxes_parallel()
+		{
+			PROFILE_SCOPE("cull");
+#if FRAME_STATS
+			stage_timer_t stage(frame_stats, cull_stage);
+#endif
+
+			// Parent test, the boxes don't need the planes the group is fully inside of
+			uint8_t parent_inside = 0;
+			AABBtoFrustum(*box_group, frustum, 0, &parent_inside, &cull_stats);
+
+			culler.cull(box_view, frustum.planes, jobs, frustum_indices, parent_inside, &cull_stats);
+
+			box_in_frustum.assign(box_view.count, 0);
+			for (uint32_t i : frustum_indices)
+				box_in_frustum[i] = 1;
+		}
+#endif
+
+#if WORLD_STREAMING
+		void stream_world(float dT)
+		{
+			world.update(view_camera.position(), dT);
+
+			const plane_t* planes = frustum.planes;
+
+			// Only fully loaded cells get here, a cell per job
+			const std::vector<const world_streamer_t::cell_t*>& cells = world.ready_cells();
+			cell_visible.assign(cells.size(), 0);
+			size_t largest = 0;
+			for (const world_streamer_t::cell_t* c : cells)
+			{
+				if (c->scene.object_count() > largest)
+					largest = c->scene.object_count();
+			}
+			cell_indices.resize(largest * cells.size());
+
+			jobs.parallel_for(cells.size(), 1, [&](size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; i++)
+				{
+					const scene_file_t& scene = cells[i]->scene;
+					cell_visible[i] = cull_aabbs(scene.bounds(), planes, 0, scene.object_count(), cell_indices.data() + i * largest);
+				}
+			});
+
+			size_t visible = 0;
+			for (size_t i = 0; i < cells.size(); i++)
+			{
+				visible += cell_visible[i];
+				if (cell_visible[i] == 0)
+					continue;
+
+				const aabb_t& b = cells[i]->scene.scene_bounds();
+				float3 corners[4] = { { b.min.x, b.min.y, b.min.z }, { b.max.x, b.min.y, b.min.z }, { b.max.x, b.min.y, b.max.z }, { b.min.x, b.min.y, b.max.z } };
+				for (int k = 0; k < 4; k++)
+					end::debug_renderer::add_line(corners[k], corners[(k + 1) % 4], YELLOW);
+			}
+
+			if (timer.TotalTime() - world_stats_time >= 1.0)
+			{
+				const world_stream_stats_t& s = world.stats();
+				printf("world: %zu cells ready, %.1f MB resident, %zu loading, %zu objects in the frustum, %zu evictions (%zu for budget)\n",
+					cells.size(), s.resident_bytes / (1024.0 * 1024.0), s.in_flight, visible, s.evictions, s.budget_evictions);
+				world_stats_time = timer.TotalTime();
+			}
+		}
+#endif
+
+#if PICKING
+		void pick_box(view_t& view)
+		{
+			PROFILE_SCOPE("pick");
+
+			float2 cursor;
+			if (!cursor_position(window, cursor))
+				return;
+
+			float ndc_x = 2.0f * cursor.x / backend->width() - 1.0f;
+			float ndc_y = 1.0f - 2.0f * cursor.y / backend->height();
+
+			// Cursor on the near and far planes back into world space, t = 1 is the far plane
+			mat4 inv_view_proj = inverse(to_mat4(view_camera.view()) * to_mat4(view.proj_mat));
+			vec3 near_point = transform_coord(make_vec3(ndc_x, ndc_y, 0.0f), inv_view_proj);
+			vec3 far_point = transform_coord(make_vec3(ndc_x, ndc_y, 1.0f), inv_view_proj);
+
+			ray_t ray;
+			ray.origin = to_float3(near_point);
+			ray.direction = to_float3(far_point - near_point);
+			ray.t_max = 1.0f;
+
+			pick_hit = box_bvh.raycast(ray);
+		}
+#endif
+
+#if BOX_TRIGGERS
+		aabb_t camera_trigger_bounds()const
+		{
+			float3 p = frustum_camera.position();
+			return { { p.x - 1.0f, p.y - 1.0f, p.z - 1.0f }, { p.x + 1.0f, p.y + 1.0f, p.z + 1.0f } };
+		}
+
+		void update_triggers()
+		{
+			PROFILE_SCOPE("triggers");
+
+			triggers.move(camera_trigger, camera_trigger_bounds());
+			triggers.update();
+
+			// The trigger box, unit cube edges around the camera
+			static constexpr auto cube = geometry::cube_lines(1.0f);
+			float3 p = frustum_camera.position();
+			for (size_t i = 0; i < cube.size(); i += 2)
+				end::debug_renderer::add_line(cube[i] + p, cube[i + 1] + p, YELLOW);
+
+			// The camera has the highest handle so it is always b, pairs of two boxes don't matter here
+			for (const overlap_pair_t& p : triggers.begun())
+			{
+				if (p.b == camera_trigger)
+					box_touched[p.a] = 1;
+			}
+			for (const overlap_pair_t& p : triggers.ended())
+			{
+				if (p.b == camera_trigger)
+					box_touched[p.a] = 0;
+			}
+		}
+#endif
+
+#if SCREEN_LOD
+		void select_box_lods(view_t& view)
+		{
+			PROFILE_SCOPE("lod");
+#if FRAME_STATS
+			stage_timer_t stage(frame_stats, lod_stage);
+#endif
+
+			lod_settings.viewport_height = backend->height();
+
+#if PARALLEL_CULL
+			// Only the frustum survivors, boxes outside keep LOD 0 so they're still drawn whole
+			const uint32_t* indices = frustum_indices.data();
+			size_t count = frustum_indices.size();
+			box_lod.assign(box_view.count, 0);
+			for (uint32_t i : frustum_indices)
+				box_lod[i] = LOD_CULLED;
+#else
+			const uint32_t* indices = nullptr;
+			size_t count = box_view.count;
+			box_lod.assign(box_view.count, LOD_CULLED);
+#endif
+
+			lod_indices.resize(count);
+			lod_kept.resize(count);
+
+			size_t kept = select_lods(box_view, indices, count, view.view_mat[3].xyz, view.proj_mat,
+				lod_settings, lod_indices.data(), lod_kept.data());
+
+			for (size_t i = 0; i < kept; i++)
+				box_lod[lod_indices[i]] = lod_kept[i];
+		}
+#endif
+
+		void draw_debug_grid(view_t& view)
+		{
+			// 21 horizontal and 21 vertical lines, built at compile time
+			static constexpr auto grid = geometry::grid_lines<10>(1.0f);
+			end::debug_renderer::add_lines(grid, WHITE);
+
+			update_mvp(view);
+			backend->draw_lines(end::debug_renderer::get_line_verts(), end::debug_renderer::get_line_vert_count());
+		}
+
+		void draw_debug_lines(view_t& view)
+		{
+			PROFILE_SCOPE("draw_debug_lines");
+#if FRAME_STATS
+			stage_timer_t stage(frame_stats, lines_stage);
+#endif
+
+			update_mvp(view);
+			{
+				PROFILE_SCOPE("upload lines");
+				backend->draw_lines(end::debug_renderer::get_line_verts(), end::debug_renderer::get_line_vert_count());
+			}
+		}
+
+		// Shaders take column major matrices
+		void update_mvp(view_t& view)
+		{
+			MVP_t mvp;
+
+			mvp.modeling = to_float4x4(transpose(mat4_identity()));
+			mvp.projection = to_float4x4(transpose(to_mat4(view.proj_mat)));
+			mvp.view = to_float4x4(transpose(to_mat4(view_camera.view())));
+
+			backend->update_mvp(mvp);
+		}
+
+#if FREE_POOL_TEST
+		void f_create_test_particles()
+		{
+			int rtn = 0;
+			do
+			{
+				rtn = fp_test.alloc();
+				if (0 <= rtn)
+				{
+					Particle p;
+					p.color = RED;
+					p.life = 0;
+					p.prev_pos = { -10,0,-10 };
+					p.pos = { -10,1,-10 };
+					fp_test[rtn] = p;
+					return;
+				}
+			} while (-1 < rtn);
+		}
+
+		void f_update_test_particles(float dt)
+		{
+			for (int i = 0; i < 100; i++)
+			{
+				fp_test[i].life += dt;
+				if (fp_test[i].life >= 2.0f)
+				{
+					fp_test.free(i);
+					continue;
+				}
+				fp_test[i].prev_pos = fp_test[i].pos;
+				fp_test[i].pos.x += sinf(dt) * sinf(i);
+				fp_test[i].pos.y += 0.001f * i;
+				fp_test[i].pos.z += sinf(i * 0.01f);
+
+				end::debug_renderer::add_line(fp_test[i].prev_pos, fp_test[i].pos, fp_test[i].color, fp_test[i].color);
+			}
+		}
+#endif
+
+#if SORTED_POOL_TEST
+		void create_test_particles()
+		{
+			int rtn = 0;
+			for (int i = 0; i < 1; i++)
+			{
+				rtn = sp_test.alloc();
+				if (0 <= rtn)
+				{
+					Particle p;
+					p.color = BLUE;
+					p.life = 0;
+					p.pos = { 10,1,-10 };
+					p.prev_pos = { 10,0,-10 };
+					sp_test[rtn] = p;
+				}
+				else
+					return;
+			}
+		}
+
+		void update_test_particles(float dt)
+		{
+			for (int i = 0; i < sp_test.size(); i++)
+			{
+				sp_test[i].life += dt;
+				if (sp_test[i].life >= 2.0f)
+				{
+					sp_test.free(i);
+					continue;
+				}
+				sp_test[i].prev_pos = sp_test[i].pos;
+				sp_test[i].pos.x += sinf(dt) * sinf(i);
+				sp_test[i].pos.y += 0.001f * i;
+				sp_test[i].pos.z += sinf(i * 0.01f);
+
+				end::debug_renderer::add_line(sp_test[i].prev_pos, sp_test[i].pos, sp_test[i].color, sp_test[i].color);
+			}
+		}
+#endif
+
+#if RENDER_PARTICLES
+		void create_emitters(int8_t emitter_index, end::float3 pos, end::float4 color)
+		{
+
+			Emitter emitter;
+			emitter.origin = pos;
+			emitter.init_color = color;
+			emitters[emitter_index] = emitter;
+		}
+
+		void create_particles(end::float3 pos, end::float4 color)
+		{
+			for (int i = 0; i < NUM_OF_EMITTERS; i++)
+			{
+				for (int currPrtcle = 0; currPrtcle < 1; currPrtcle++)
+				{
+					Particle p;
+					p.prev_pos = emitters[i].origin;
+					p.pos = emitters[i].origin;
+					p.color = color;
+					// Check Particle pool for free spot
+					int p_index = particles.alloc();
+					if (p_index < 0)
+					{
+						particles.free(p_index);
+						return; // No more particles
+					}
+					else
+					{
+						// Check Emitter for free spot
+						int e_index = emitters[i].parti_indices.alloc();
+						if (e_index < 0)
+						{
+							particles.free(p_index); // Emitter had no empty spot for this particle so put it back.
+							break; // try next emitter
+						}
+						else
+						{
+							emitters[i].parti_indices[e_index] = p_index;
+							particles[p_index] = p;
+						}
+					}
+				}
+			}
+		}
+
+		void update_particles(int16_t em_index, float dT, end::float4 nColor)
+		{
+			int size = emitters[em_index].parti_indices.size();
+			for (int i = 0; i < size; i++)
+			{
+				if (particles[emitters[em_index].parti_indices[i]].life > 1.0f)
+				{
+					kill_particle(emitters[em_index], i);
+					i--;
+					continue;
+				}
+
+
+				end::float3 dir;
+				// fountain math
+				dir.x = (cosf(dT * i) * sinf(-i));// cosf(dT * (3.14156 / 180)) * 0.1f;
+				dir.y = 0.001f;
+				dir.z = (sinf(dT * i) * sinf(-i));// -cosf(dT * (3.14156 / 180)) * 0.1f;
+				float scalar = -.0986f;
+				//dir.x = dT;
+				//dir.y = dir.x * scalar;
+				Particle nP = particles[emitters[em_index].parti_indices[i]];
+				nP.prev_pos = nP.pos;
+				nP.pos = nP.pos + (dir * scalar);
+				nP.color = (nColor);
+				nP.color.w = 1.0f;
+				nP.life += dT;
+				particles[emitters[em_index].parti_indices[i]] = nP;
+				end::float4 p = { particles[emitters[em_index].parti_indices[i]].prev_pos.x,
+								particles[emitters[em_index].parti_indices[i]].prev_pos.y,
+								particles[emitters[em_index].parti_indices[i]].prev_pos.z, 1.0f };
+				end::float4 q = { particles[emitters[em_index].parti_indices[i]].pos.x,
+								particles[emitters[em_index].parti_indices[i]].pos.y,
+								particles[emitters[em_index].parti_indices[i]].pos.z, 1.0f };
+				debug_renderer::add_line(p, q, particles[emitters[em_index].parti_indices[i]].color);
+			}
+		}
+
+		void clear_particles(Emitter& em)
+		{
+			for (int i = 0; i < em.parti_indices.size(); i++)
+			{
+				// free particle
+				particles.free(em.parti_indices[i]);
+				// free indice
+				em.parti_indices.free(i);
+			}
+		}
+
+		void kill_particle(Emitter& em, int index)
+		{
+			// free particle
+			particles.free(em.parti_indices[index]);
+			// free indice
+			em.parti_indices.free(index);
+		}
+#endif
+
+		~impl_t()
+		{
+#if PROFILE_TRACE
+			if (!trace_path.empty())
+			{
+				profiler::stop();
+				profiler::write_chrome_trace(trace_path.c_str());
+			}
+#endif
+#if FRAME_STATS
+			if (!frame_stats_path.empty())
+				frame_stats.write_csv(frame_stats_path.c_str());
+#endif
+#if CAMERA_RECORD
+			recorded_path.save("camera_path.txt");
+#endif
+			// TODO:
+			//Clean-up
+#if FRUSTUM
+			for (int b = 0; b < boxes.size(); b++)
+			{
+				if (boxes[b] != nullptr)
+				{
+					delete boxes[b];
+					boxes[b] = nullptr;
+				}
+			}
+			delete box_group;
+#endif
+
+#if RENDER_PARTICLES
+			for (int i = 0; i < NUM_OF_EMITTERS; i++)
+				clear_particles(emitters[i]);
+#endif
+		}
+	};
+
+};
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include "scene_file.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace end
+{
+	namespace
+	{
+		struct section_source_t
+		{
+			uint32_t id;
+			uint32_t stride;
+			const void* data;
+		};
+
+		size_t align_up(size_t value, size_t alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		void set_error(std::string* error, const std::string& message)
+		{
+			if (error)
+				*error = message;
+		}
+
+		// Writes zeros up to offset
+		bool pad_to(FILE* file, size_t& written, size_t offset)
+		{
+			static const uint8_t zeros[SCENE_ALIGNMENT] = {};
+			while (written < offset)
+			{
+				size_t n = std::min(offset - written, sizeof(zeros));
+				if (fwrite(zeros, 1, n, file) != n)
+					return false;
+				written += n;
+			}
+			return true;
+		}
+
+		aabb_t enclose(const aabb_soa_view_t& boxes)
+		{
+			if (boxes.count == 0)
+				return {};
+
+			aabb_t out = boxes.get(0);
+			for (size_t i = 1; i < boxes.count; i++)
+			{
+				out.min.x = std::min(out.min.x, boxes.min_x[i]);
+				out.min.y = std::min(out.min.y, boxes.min_y[i]);
+				out.min.z = std::min(out.min.z, boxes.min_z[i]);
+				out.max.x = std::max(out.max.x, boxes.max_x[i]);
+				out.max.y = std::max(out.max.y, boxes.max_y[i]);
+				out.max.z = std::max(out.max.z, boxes.max_z[i]);
+			}
+			return out;
+		}
+	}
+
+	bool write_scene_file(const char* path, const scene_data_t& scene, std::string* error)
+	{
+		const aabb_soa_view_t& b = scene.bounds;
+		std::vector<section_source_t> sources =
+		{
+			{ SCENE_MIN_X, sizeof(float), b.min_x },
+			{ SCENE_MIN_Y, sizeof(float), b.min_y },
+			{ SCENE_MIN_Z, sizeof(float), b.min_z },
+			{ SCENE_MAX_X, sizeof(float), b.max_x },
+			{ SCENE_MAX_Y, sizeof(float), b.max_y },
+			{ SCENE_MAX_Z, sizeof(float), b.max_z },
+		};
+		if (scene.transforms)
+			sources.push_back({ SCENE_TRANSFORMS, sizeof(float4x4), scene.transforms });
+		if (scene.flags)
+			sources.push_back({ SCENE_FLAGS, sizeof(uint32_t), scene.flags });
+
+		scene_header_t header;
+		memset(&header, 0, sizeof(header));
+		header.magic = SCENE_MAGIC;
+		header.version = SCENE_VERSION;
+		header.object_count = b.count;
+		header.section_count = (uint32_t)sources.size();
+		header.bounds = enclose(b);
+
+		std::vector<scene_section_t> sections(sources.size());
+		size_t offset = align_up(sizeof(header) + sections.size() * sizeof(scene_section_t), SCENE_ALIGNMENT);
+		for (size_t i = 0; i < sources.size(); i++)
+		{
+			scene_section_t& s = sections[i];
+			memset(&s, 0, sizeof(s));
+			s.id = sources[i].id;
+			s.stride = sources[i].stride;
+			s.offset = offset;
+			s.size = (uint64_t)s.stride * b.count;
+			offset = align_up(offset + (size_t)s.size, SCENE_ALIGNMENT);
+		}
+
+		FILE* file = fopen(path, "wb");
+		if (!file)
+		{
+			set_error(error, std::string("can't open ") + path);
+			return false;
+		}
+
+		// Written front to back, padding included, so the file never needs a seek past 2 GB
+		size_t written = 0;
+		bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+		written += sizeof(header);
+		ok = ok && fwrite(sections.data(), sizeof(scene_section_t), sections.size(), file) == sections.size();
+		written += sections.size() * sizeof(scene_section_t);
+
+		for (size_t i = 0; i < sections.size() && ok; i++)
+		{
+			size_t size = (size_t)sections[i].size;
+			ok = pad_to(file, written, (size_t)sections[i].offset);
+			if (ok && size)
+				ok = fwrite(sources[i].data, size, 1, file) == 1;
+			written += size;
+		}
+
+		if (fclose(file) != 0)
+			ok = false;
+		if (!ok)
+			set_error(error, std::string("write failed: ") + path);
+		return ok;
+	}
+
+	bool scene_file_t::open(const char* path)
+	{
+		close();
+
+		file = map_binary_blob(path);
+		if (file.size() < sizeof(scene_header_t) || (uintptr_t)file.data() % alignof(float4_a) != 0)
+		{
+			close();
+			return false;
+		}
+
+		memcpy(&header, file.data(), sizeof(header));
+
+		size_t size = file.size();
+		bool valid = header.magic == SCENE_MAGIC && header.version == SCENE_VERSION &&
+			header.section_count <= (size - sizeof(header)) / sizeof(scene_section_t);
+		if (!valid)
+		{
+			close();
+			return false;
+		}
+
+		const scene_section_t* sections = (const scene_section_t*)(file.data() + sizeof(header));
+		const void* found[SCENE_SECTION_COUNT] = {};
+		const uint32_t strides[SCENE_SECTION_COUNT] =
+		{
+			sizeof(float), sizeof(float), sizeof(float), sizeof(float), sizeof(float), sizeof(float),
+			sizeof(float4x4), sizeof(uint32_t)
+		};
+
+		for (uint32_t i = 0; i < header.section_count; i++)
+		{
+			const scene_section_t& s = sections[i];
+			if (s.id >= SCENE_SECTION_COUNT)
+				continue;
+
+			bool fits = s.stride == strides[s.id] && s.offset % SCENE_ALIGNMENT == 0 && header.object_count <= size / s.stride &&
+				s.size == (uint64_t)s.stride * header.object_count && s.offset <= size && s.size <= size - s.offset;
+			if (!fits)
+			{
+				close();
+				return false;
+			}
+			found[s.id] = file.data() + s.offset;
+		}
+
+		for (uint32_t i = SCENE_MIN_X; i <= SCENE_MAX_Z; i++)
+		{
+			if (!found[i])
+			{
+				close();
+				return false;
+			}
+			bound_data[i] = (const float*)found[i];
+		}
+		transform_data = (const float4x4*)found[SCENE_TRANSFORMS];
+		flag_data = (const uint32_t*)found[SCENE_FLAGS];
+		return true;
+	}
+
+	void scene_file_t::close()
+	{
+		file = mapped_blob_t{};
+		header = scene_header_t{};
+		std::fill(std::begin(bound_data), std::end(bound_data), nullptr);
+		transform_data = nullptr;
+		flag_data = nullptr;
+	}
+
+	aabb_soa_view_t scene_file_t::bounds()const
+	{
+		return { bound_data[0], bound_data[1], bound_data[2], bound_data[3], bound_data[4], bound_data[5], object_count() };
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "blob.h"
+#include "bounds.h"
+#include "math_types.h"
+
+namespace end
+{
+	// Binary scene of static objects, used in place from a memory mapping.
+	//
+	//	header | section table | arrays
+	//	Every per object array is a section starting on a 64 byte boundary, laid out exactly as the
+	//	batched systems read it: bounds as six float arrays (aabb_soa_view_t), then optional transforms
+	//	and flags. Opening reads the header and the section table only, the arrays are never parsed or
+	//	copied, so the cost of a load is the page faults of whatever gets touched.
+	//	All integers and floats are little endian. Unknown section ids are skipped, so new optional
+	//	arrays don't need a version change; SCENE_VERSION only changes when the layout of existing ones does.
+
+	constexpr uint32_t SCENE_MAGIC = 0x53444E45; // "ENDS"
+	constexpr uint32_t SCENE_VERSION = 1;
+	constexpr size_t SCENE_ALIGNMENT = 64;
+
+	enum scene_section_id_t : uint32_t
+	{
+		SCENE_MIN_X,
+		SCENE_MIN_Y,
+		SCENE_MIN_Z,
+		SCENE_MAX_X,
+		SCENE_MAX_Y,
+		SCENE_MAX_Z,
+		SCENE_TRANSFORMS,	// float4x4 per object, row major like the renderer's matrices
+		SCENE_FLAGS,		// uint32_t per object, SCENE_OBJECT_*
+		SCENE_SECTION_COUNT
+	};
+
+	// Object flags
+	constexpr uint32_t SCENE_OBJECT_OCCLUDER = 1 << 0;
+	constexpr uint32_t SCENE_OBJECT_PICKABLE = 1 << 1;
+
+	struct scene_header_t
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t object_count;
+		uint32_t section_count;
+		uint32_t reserved0;
+		aabb_t bounds;			// encloses every object
+		uint8_t reserved[16];
+	};
+	static_assert(sizeof(scene_header_t) == 64, "scene header layout");
+
+	struct scene_section_t
+	{
+		uint32_t id;
+		uint32_t stride;		// bytes per object
+		uint64_t offset;		// from the start of the file, SCENE_ALIGNMENT aligned
+		uint64_t size;			// stride * object_count
+		uint64_t reserved;
+	};
+	static_assert(sizeof(scene_section_t) == 32, "scene section layout");
+
+	// What write_scene_file stores, transforms and flags are optional
+	struct scene_data_t
+	{
+		aabb_soa_view_t bounds;
+		const float4x4* transforms = nullptr;
+		const uint32_t* flags = nullptr;
+	};
+
+	// false (with a message in error) if the file can't be written
+	bool write_scene_file(const char* path, const scene_data_t& scene, std::string* error = nullptr);
+
+	// Reader over one mapping of the file (map_binary_blob, so a buffered read if mapping fails)
+	class scene_file_t
+	{
+	public:
+
+		// false if missing, another version or the sections don't fit the file
+		bool open(const char* path);
+		void close();
+
+		bool is_open()const { return bound_data[0] != nullptr; }
+		size_t object_count()const { return (size_t)header.object_count; }
+		const aabb_t& scene_bounds()const { return header.bounds; }
+		size_t file_size()const { return file.size(); }	// the whole mapping, header and padding included
+
+		// Point into the mapping, valid until close
+		aabb_soa_view_t bounds()const;
+		const float4x4* transforms()const { return transform_data; }	// nullptr if the file has none
+		const uint32_t* flags()const { return flag_data; }				// nullptr if the file has none
+
+	private:
+
+		mapped_blob_t file;
+		scene_header_t header{};
+		const float* bound_data[6] = {};
+		const float4x4* transform_data = nullptr;
+		const uint32_t* flag_data = nullptr;
+	};
+}
@@ -0,0 +1,65 @@
+// Unit cube tables shared by vs_cube.hlsl and the C++ side (geometry.h)
+#ifdef __cplusplus
+#pragma once
+#include <cstdint>
+namespace end
+{
+	namespace cube_tables
+	{
+		using uint = uint32_t;
+#define CUBE_TABLE static constexpr
+#else
+#define CUBE_TABLE static const
+#endif
+
+CUBE_TABLE float4 cube_n[6] =
+{
+	{ -1.0f, 0.0f, 0.0f, 0.0f },
+	{ 1.0f, 0.0f, 0.0f, 0.0f },
+	{ 0.0f, -1.0f, 0.0f, 0.0f },
+	{ 0.0f, 1.0f, 0.0f, 0.0f },
+	{ 0.0f, 0.0f, -1.0f, 0.0f },
+	{ 0.0f, 0.0f, 1.0f, 0.0f },
+};
+
+// Bit 2/1/0 of the index is +x/+y/+z
+CUBE_TABLE float4 cube_v[8] =
+{
+	{ -1.0f,-1.0f,-1.0f, 1.0f },
+	{ -1.0f,-1.0f, 1.0f, 1.0f },
+	{ -1.0f, 1.0f,-1.0f, 1.0f },
+	{ -1.0f, 1.0f, 1.0f, 1.0f },
+
+	{ 1.0f,-1.0f,-1.0f, 1.0f },
+	{ 1.0f,-1.0f, 1.0f, 1.0f },
+	{ 1.0f, 1.0f,-1.0f, 1.0f },
+	{ 1.0f, 1.0f, 1.0f, 1.0f },
+};
+
+// Two triangles per face, in cube_n order
+CUBE_TABLE uint cube_i[36] =
+{
+	0,1,2, // -x
+	1,3,2,
+
+	4,6,5, // +x
+	5,6,7,
+
+	0,5,1, // -y
+	0,4,5,
+
+	2,7,6, // +y
+	2,3,7,
+
+	0,6,4, // -z
+	0,2,6,
+
+	1,7,3, // +z
+	1,5,7
+};
+
+#undef CUBE_TABLE
+#ifdef __cplusplus
+	}
+}
+#endif
@@ -1,6 +1,6 @@
 #ifdef __cplusplus
 #define cbuffer struct
-#define matrix DirectX::XMMATRIX
+#define matrix end::float4x4_a // same 64 bytes as XMMATRIX, keeps the renderer off DirectXMath
 #endif
 
 cbuffer MVP_t
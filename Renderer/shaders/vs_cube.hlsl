@@ -1,4 +1,5 @@
 #include "mvp.hlsli"
+#include "cube_tables.hlsli"
 
 struct VSIn
 {
@@ -12,50 +13,6 @@ struct VSOut
 	float4 color : COLOR;
 };
 
-static const float4 cube_n[6] =
-{
-	float4(-1.0f, 0.0f, 0.0f, 0.0f),
-	float4(1.0f, 0.0f, 0.0f, 0.0f),
-	float4(0.0f, -1.0f, 0.0f, 0.0f),
-	float4(0.0f, 1.0f, 0.0f, 0.0f),
-	float4(0.0f, 0.0f, -1.0f, 0.0f),
-	float4(0.0f, 0.0f, 1.0f, 0.0f),
-};
-
-static const float4 cube_v[8] =
-{
-	float4(-1.0f,-1.0f,-1.0f, 1.0f),
-	float4(-1.0f,-1.0f, 1.0f, 1.0f),
-	float4(-1.0f, 1.0f,-1.0f, 1.0f),
-	float4(-1.0f, 1.0f, 1.0f, 1.0f),
-
-	float4(1.0f,-1.0f,-1.0f, 1.0f),
-	float4(1.0f,-1.0f, 1.0f, 1.0f),
-	float4(1.0f, 1.0f,-1.0f, 1.0f),
-	float4(1.0f, 1.0f, 1.0f, 1.0f),
-};
-
-static const uint cube_i[36] =
-{
-	0,1,2, // -x
-	1,3,2,
-
-	4,6,5, // +x
-	5,6,7,
-
-	0,5,1, // -y
-	0,4,5,
-
-	2,7,6, // +y
-	2,3,7,
-
-	0,6,4, // -z
-	0,2,6,
-
-	1,7,3, // +z
-	1,5,7
-};
-
 VSOut main(VSIn input)
 {
 	VSOut output;
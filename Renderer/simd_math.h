@@ -0,0 +1,489 @@
+#pragma once
+
+#include <cmath>
+
+#include "math_types.h"
+
+// Portable SIMD math for the CPU side of the engine.
+//
+//	vec3, vec4, mat4 and quat are stored in 128 bit registers: SSE on x86/x64,
+//	plain floats everywhere else or when END_SIMD_SCALAR is defined.
+//	Builds with AVX (/arch:AVX, -mavx) also use the AVX forms: one source shuffles, dp_ps dots,
+//	two mat4 rows per 256 bit register in mat4 * mat4, and fused multiply-add with FMA (/arch:AVX2, -mfma).
+//	The types stay 4 wide, a vec4 has no use for 8 lanes.
+//	Conventions match DirectXMath so results can be handed straight to the renderer:
+//	row vectors (p * M), left handed, rows of a mat4 have the same layout as float4x4_a.
+//	Load from and store to float3/float4/float4x4_a at the system boundaries, keep the
+//	math in these types in between.
+#if !defined(END_SIMD_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define END_SIMD_SSE 1
+#include <emmintrin.h>
+#else
+#define END_SIMD_SSE 0
+#endif
+
+#if END_SIMD_SSE && defined(__AVX__)
+#define END_SIMD_AVX 1
+#include <immintrin.h>
+#else
+#define END_SIMD_AVX 0
+#endif
+
+#if END_SIMD_AVX && (defined(__FMA__) || defined(__AVX2__))
+#define END_SIMD_FMA 1
+#else
+#define END_SIMD_FMA 0
+#endif
+
+namespace end
+{
+	namespace simd
+	{
+#if END_SIMD_SSE
+		using reg_t = __m128;
+
+		inline reg_t load(const float* p) { return _mm_loadu_ps(p); }
+		inline void store(float* p, reg_t r) { _mm_storeu_ps(p, r); }
+		inline reg_t set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+		inline reg_t splat(float s) { return _mm_set1_ps(s); }
+		inline reg_t zero() { return _mm_setzero_ps(); }
+
+		inline reg_t add(reg_t a, reg_t b) { return _mm_add_ps(a, b); }
+		inline reg_t sub(reg_t a, reg_t b) { return _mm_sub_ps(a, b); }
+		inline reg_t mul(reg_t a, reg_t b) { return _mm_mul_ps(a, b); }
+		inline reg_t div(reg_t a, reg_t b) { return _mm_div_ps(a, b); }
+		inline reg_t min(reg_t a, reg_t b) { return _mm_min_ps(a, b); }
+		inline reg_t max(reg_t a, reg_t b) { return _mm_max_ps(a, b); }
+
+		// a * b + c
+#if END_SIMD_FMA
+		inline reg_t madd(reg_t a, reg_t b, reg_t c) { return _mm_fmadd_ps(a, b, c); }
+#else
+		inline reg_t madd(reg_t a, reg_t b, reg_t c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+#endif
+
+#if END_SIMD_AVX
+		template<int i>
+		inline reg_t splat_lane(reg_t r) { return _mm_permute_ps(r, _MM_SHUFFLE(i, i, i, i)); }
+#else
+		template<int i>
+		inline reg_t splat_lane(reg_t r) { return _mm_shuffle_ps(r, r, _MM_SHUFFLE(i, i, i, i)); }
+#endif
+
+		inline float lane_x(reg_t r) { return _mm_cvtss_f32(r); }
+
+		// Zeroes w, vec3 keeps it 0 so 4 wide ops don't mix garbage into dot products
+		inline reg_t clear_w(reg_t r) { return _mm_and_ps(r, _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0))); }
+
+#if END_SIMD_AVX
+		inline float dot3(reg_t a, reg_t b) { return _mm_cvtss_f32(_mm_dp_ps(a, b, 0x71)); }
+		inline float dot4(reg_t a, reg_t b) { return _mm_cvtss_f32(_mm_dp_ps(a, b, 0xF1)); }
+#else
+		inline float dot3(reg_t a, reg_t b)
+		{
+			reg_t m = _mm_mul_ps(a, b);
+			reg_t y = _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1));
+			reg_t z = _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 2, 2, 2));
+			return _mm_cvtss_f32(_mm_add_ss(_mm_add_ss(m, y), z));
+		}
+
+		inline float dot4(reg_t a, reg_t b)
+		{
+			reg_t m = _mm_mul_ps(a, b);
+			reg_t s = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+			s = _mm_add_ss(s, _mm_movehl_ps(s, s));
+			return _mm_cvtss_f32(s);
+		}
+#endif
+
+		// w of the result is 0
+		inline reg_t cross3(reg_t a, reg_t b)
+		{
+			reg_t a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+			reg_t b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+			reg_t c = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+			return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+		}
+#else
+		struct reg_t
+		{
+			float v[4];
+		};
+
+		inline reg_t load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+		inline void store(float* p, reg_t r) { for (int i = 0; i < 4; i++) p[i] = r.v[i]; }
+		inline reg_t set(float x, float y, float z, float w) { return { { x, y, z, w } }; }
+		inline reg_t splat(float s) { return { { s, s, s, s } }; }
+		inline reg_t zero() { return splat(0.0f); }
+
+		inline reg_t add(reg_t a, reg_t b) { return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } }; }
+		inline reg_t sub(reg_t a, reg_t b) { return { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } }; }
+		inline reg_t mul(reg_t a, reg_t b) { return { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } }; }
+		inline reg_t div(reg_t a, reg_t b) { return { { a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3] } }; }
+		inline reg_t min(reg_t a, reg_t b) { return { { a.v[0] < b.v[0] ? a.v[0] : b.v[0], a.v[1] < b.v[1] ? a.v[1] : b.v[1], a.v[2] < b.v[2] ? a.v[2] : b.v[2], a.v[3] < b.v[3] ? a.v[3] : b.v[3] } }; }
+		inline reg_t max(reg_t a, reg_t b) { return { { a.v[0] > b.v[0] ? a.v[0] : b.v[0], a.v[1] > b.v[1] ? a.v[1] : b.v[1], a.v[2] > b.v[2] ? a.v[2] : b.v[2], a.v[3] > b.v[3] ? a.v[3] : b.v[3] } }; }
+
+		inline reg_t madd(reg_t a, reg_t b, reg_t c) { return add(mul(a, b), c); }
+
+		template<int i>
+		inline reg_t splat_lane(reg_t r) { return splat(r.v[i]); }
+
+		inline float lane_x(reg_t r) { return r.v[0]; }
+
+		inline reg_t clear_w(reg_t r) { r.v[3] = 0.0f; return r; }
+
+		inline float dot3(reg_t a, reg_t b) { return a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2]; }
+		inline float dot4(reg_t a, reg_t b) { return dot3(a, b) + a.v[3] * b.v[3]; }
+
+		inline reg_t cross3(reg_t a, reg_t b)
+		{
+			return { { a.v[1] * b.v[2] - a.v[2] * b.v[1], a.v[2] * b.v[0] - a.v[0] * b.v[2], a.v[0] * b.v[1] - a.v[1] * b.v[0], 0.0f } };
+		}
+#endif
+	}
+
+	struct vec3
+	{
+		simd::reg_t r;
+	};
+
+	struct vec4
+	{
+		simd::reg_t r;
+	};
+
+	// Rows, v * m like XMVector4Transform
+	struct mat4
+	{
+		simd::reg_t r[4];
+	};
+
+	// x, y, z, w with w the scalar part
+	struct quat
+	{
+		simd::reg_t r;
+	};
+
+	// Construction and conversion //
+
+	inline vec3 make_vec3(float x, float y, float z) { return { simd::set(x, y, z, 0.0f) }; }
+	inline vec4 make_vec4(float x, float y, float z, float w) { return { simd::set(x, y, z, w) }; }
+	inline vec4 make_vec4(vec3 v, float w) { return { simd::add(v.r, simd::set(0.0f, 0.0f, 0.0f, w)) }; }
+
+	inline vec3 to_vec3(const float3& f) { return make_vec3(f.x, f.y, f.z); }
+	inline vec4 to_vec4(const float4& f) { return { simd::load(f.data()) }; }
+
+	inline float3 to_float3(vec3 v)
+	{
+		float f[4];
+		simd::store(f, v.r);
+		return { f[0], f[1], f[2] };
+	}
+
+	inline float4 to_float4(vec4 v)
+	{
+		float4 f;
+		simd::store(f.data(), v.r);
+		return f;
+	}
+
+	inline vec3 xyz(vec4 v) { return { simd::clear_w(v.r) }; }
+
+	inline mat4 to_mat4(const float4x4_a& m)
+	{
+		return { { simd::load(m[0].data()), simd::load(m[1].data()), simd::load(m[2].data()), simd::load(m[3].data()) } };
+	}
+
+	inline float4x4_a to_float4x4(const mat4& m)
+	{
+		float4x4_a f;
+		for (int i = 0; i < 4; i++)
+			simd::store(f[i].data(), m.r[i]);
+		return f;
+	}
+
+	// vec3 //
+
+	inline vec3 operator+(vec3 a, vec3 b) { return { simd::add(a.r, b.r) }; }
+	inline vec3 operator-(vec3 a, vec3 b) { return { simd::sub(a.r, b.r) }; }
+	inline vec3 operator-(vec3 a) { return { simd::sub(simd::zero(), a.r) }; }
+	inline vec3 operator*(vec3 a, vec3 b) { return { simd::mul(a.r, b.r) }; }
+	inline vec3 operator*(vec3 a, float s) { return { simd::mul(a.r, simd::splat(s)) }; }
+	inline vec3 operator*(float s, vec3 a) { return a * s; }
+	inline vec3 operator/(vec3 a, float s) { return a * (1.0f / s); }
+	inline vec3& operator+=(vec3& a, vec3 b) { return a = a + b; }
+	inline vec3& operator-=(vec3& a, vec3 b) { return a = a - b; }
+	inline vec3& operator*=(vec3& a, float s) { return a = a * s; }
+
+	inline float dot(vec3 a, vec3 b) { return simd::dot3(a.r, b.r); }
+	inline vec3 cross(vec3 a, vec3 b) { return { simd::cross3(a.r, b.r) }; }
+	inline float length_sq(vec3 a) { return dot(a, a); }
+	inline float length(vec3 a) { return std::sqrt(dot(a, a)); }
+	inline vec3 normalize(vec3 a) { return a * (1.0f / length(a)); }
+	inline vec3 min(vec3 a, vec3 b) { return { simd::min(a.r, b.r) }; }
+	inline vec3 max(vec3 a, vec3 b) { return { simd::max(a.r, b.r) }; }
+	inline vec3 lerp(vec3 a, vec3 b, float t) { return a + (b - a) * t; }
+	inline float get_x(vec3 a) { return simd::lane_x(a.r); }
+	inline float get_y(vec3 a) { return simd::lane_x(simd::splat_lane<1>(a.r)); }
+	inline float get_z(vec3 a) { return simd::lane_x(simd::splat_lane<2>(a.r)); }
+
+	// vec4 //
+
+	inline vec4 operator+(vec4 a, vec4 b) { return { simd::add(a.r, b.r) }; }
+	inline vec4 operator-(vec4 a, vec4 b) { return { simd::sub(a.r, b.r) }; }
+	inline vec4 operator*(vec4 a, vec4 b) { return { simd::mul(a.r, b.r) }; }
+	inline vec4 operator*(vec4 a, float s) { return { simd::mul(a.r, simd::splat(s)) }; }
+	inline vec4 operator*(float s, vec4 a) { return a * s; }
+
+	inline float dot(vec4 a, vec4 b) { return simd::dot4(a.r, b.r); }
+	inline float length(vec4 a) { return std::sqrt(dot(a, a)); }
+	inline vec4 normalize(vec4 a) { return a * (1.0f / length(a)); }
+	inline vec4 min(vec4 a, vec4 b) { return { simd::min(a.r, b.r) }; }
+	inline vec4 max(vec4 a, vec4 b) { return { simd::max(a.r, b.r) }; }
+	inline vec4 lerp(vec4 a, vec4 b, float t) { return a + (b - a) * t; }
+
+	// mat4 //
+
+	inline mat4 mat4_identity()
+	{
+		return { { simd::set(1, 0, 0, 0), simd::set(0, 1, 0, 0), simd::set(0, 0, 1, 0), simd::set(0, 0, 0, 1) } };
+	}
+
+	inline simd::reg_t transform(simd::reg_t v, const mat4& m)
+	{
+		simd::reg_t out = simd::mul(simd::splat_lane<0>(v), m.r[0]);
+		out = simd::madd(simd::splat_lane<1>(v), m.r[1], out);
+		out = simd::madd(simd::splat_lane<2>(v), m.r[2], out);
+		return simd::madd(simd::splat_lane<3>(v), m.r[3], out);
+	}
+
+	inline vec4 operator*(vec4 v, const mat4& m) { return { transform(v.r, m) }; }
+
+	// a * b applies a first, like XMMatrixMultiply
+#if END_SIMD_AVX
+	inline mat4 operator*(const mat4& a, const mat4& b)
+	{
+		// Rows of a two at a time, b's rows in both halves. permute_ps shuffles within each half.
+		__m256 b0 = _mm256_insertf128_ps(_mm256_castps128_ps256(b.r[0]), b.r[0], 1);
+		__m256 b1 = _mm256_insertf128_ps(_mm256_castps128_ps256(b.r[1]), b.r[1], 1);
+		__m256 b2 = _mm256_insertf128_ps(_mm256_castps128_ps256(b.r[2]), b.r[2], 1);
+		__m256 b3 = _mm256_insertf128_ps(_mm256_castps128_ps256(b.r[3]), b.r[3], 1);
+
+		auto rows = [&](simd::reg_t r0, simd::reg_t r1)
+		{
+			__m256 a2 = _mm256_insertf128_ps(_mm256_castps128_ps256(r0), r1, 1);
+			__m256 out = _mm256_mul_ps(_mm256_permute_ps(a2, 0x00), b0);
+#if END_SIMD_FMA
+			out = _mm256_fmadd_ps(_mm256_permute_ps(a2, 0x55), b1, out);
+			out = _mm256_fmadd_ps(_mm256_permute_ps(a2, 0xAA), b2, out);
+			return _mm256_fmadd_ps(_mm256_permute_ps(a2, 0xFF), b3, out);
+#else
+			out = _mm256_add_ps(_mm256_mul_ps(_mm256_permute_ps(a2, 0x55), b1), out);
+			out = _mm256_add_ps(_mm256_mul_ps(_mm256_permute_ps(a2, 0xAA), b2), out);
+			return _mm256_add_ps(_mm256_mul_ps(_mm256_permute_ps(a2, 0xFF), b3), out);
+#endif
+		};
+
+		__m256 r01 = rows(a.r[0], a.r[1]);
+		__m256 r23 = rows(a.r[2], a.r[3]);
+		return { { _mm256_castps256_ps128(r01), _mm256_extractf128_ps(r01, 1), _mm256_castps256_ps128(r23), _mm256_extractf128_ps(r23, 1) } };
+	}
+#else
+	inline mat4 operator*(const mat4& a, const mat4& b)
+	{
+		return { { transform(a.r[0], b), transform(a.r[1], b), transform(a.r[2], b), transform(a.r[3], b) } };
+	}
+#endif
+
+	// Point with w = 1, no divide (affine matrices)
+	inline vec3 transform_point(vec3 p, const mat4& m)
+	{
+		simd::reg_t out = simd::madd(simd::splat_lane<0>(p.r), m.r[0], m.r[3]);
+		out = simd::madd(simd::splat_lane<1>(p.r), m.r[1], out);
+		out = simd::madd(simd::splat_lane<2>(p.r), m.r[2], out);
+		return { simd::clear_w(out) };
+	}
+
+	// Point with w = 1 divided by the resulting w, like XMVector3TransformCoord
+	inline vec3 transform_coord(vec3 p, const mat4& m)
+	{
+		simd::reg_t out = simd::madd(simd::splat_lane<0>(p.r), m.r[0], m.r[3]);
+		out = simd::madd(simd::splat_lane<1>(p.r), m.r[1], out);
+		out = simd::madd(simd::splat_lane<2>(p.r), m.r[2], out);
+		return { simd::clear_w(simd::div(out, simd::splat_lane<3>(out))) };
+	}
+
+	// Direction with w = 0, translation is ignored
+	inline vec3 transform_vector(vec3 v, const mat4& m)
+	{
+		simd::reg_t out = simd::mul(simd::splat_lane<0>(v.r), m.r[0]);
+		out = simd::madd(simd::splat_lane<1>(v.r), m.r[1], out);
+		out = simd::madd(simd::splat_lane<2>(v.r), m.r[2], out);
+		return { simd::clear_w(out) };
+	}
+
+	inline mat4 transpose(const mat4& m)
+	{
+		float f[4][4];
+		for (int i = 0; i < 4; i++)
+			simd::store(f[i], m.r[i]);
+		return { {
+			simd::set(f[0][0], f[1][0], f[2][0], f[3][0]),
+			simd::set(f[0][1], f[1][1], f[2][1], f[3][1]),
+			simd::set(f[0][2], f[1][2], f[2][2], f[3][2]),
+			simd::set(f[0][3], f[1][3], f[2][3], f[3][3]) } };
+	}
+
+	// General inverse by cofactors, returns the identity for singular matrices
+	inline mat4 inverse(const mat4& m)
+	{
+		float a[16];
+		for (int i = 0; i < 4; i++)
+			simd::store(a + i * 4, m.r[i]);
+
+		float s0 = a[0] * a[5] - a[4] * a[1];
+		float s1 = a[0] * a[6] - a[4] * a[2];
+		float s2 = a[0] * a[7] - a[4] * a[3];
+		float s3 = a[1] * a[6] - a[5] * a[2];
+		float s4 = a[1] * a[7] - a[5] * a[3];
+		float s5 = a[2] * a[7] - a[6] * a[3];
+
+		float c5 = a[10] * a[15] - a[14] * a[11];
+		float c4 = a[9] * a[15] - a[13] * a[11];
+		float c3 = a[9] * a[14] - a[13] * a[10];
+		float c2 = a[8] * a[15] - a[12] * a[11];
+		float c1 = a[8] * a[14] - a[12] * a[10];
+		float c0 = a[8] * a[13] - a[12] * a[9];
+
+		float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+		if (det == 0.0f)
+			return mat4_identity();
+
+		float k = 1.0f / det;
+		return { {
+			simd::set((a[5] * c5 - a[6] * c4 + a[7] * c3) * k, (-a[1] * c5 + a[2] * c4 - a[3] * c3) * k, (a[13] * s5 - a[14] * s4 + a[15] * s3) * k, (-a[9] * s5 + a[10] * s4 - a[11] * s3) * k),
+			simd::set((-a[4] * c5 + a[6] * c2 - a[7] * c1) * k, (a[0] * c5 - a[2] * c2 + a[3] * c1) * k, (-a[12] * s5 + a[14] * s2 - a[15] * s1) * k, (a[8] * s5 - a[10] * s2 + a[11] * s1) * k),
+			simd::set((a[4] * c4 - a[5] * c2 + a[7] * c0) * k, (-a[0] * c4 + a[1] * c2 - a[3] * c0) * k, (a[12] * s4 - a[13] * s2 + a[15] * s0) * k, (-a[8] * s4 + a[9] * s2 - a[11] * s0) * k),
+			simd::set((-a[4] * c3 + a[5] * c1 - a[6] * c0) * k, (a[0] * c3 - a[1] * c1 + a[2] * c0) * k, (-a[12] * s3 + a[13] * s1 - a[14] * s0) * k, (a[8] * s3 - a[9] * s1 + a[10] * s0) * k) } };
+	}
+
+	inline mat4 mat4_translation(vec3 t)
+	{
+		mat4 m = mat4_identity();
+		m.r[3] = make_vec4(t, 1.0f).r;
+		return m;
+	}
+
+	inline mat4 mat4_scaling(vec3 s)
+	{
+		return { { simd::mul(s.r, simd::set(1, 0, 0, 0)), simd::mul(s.r, simd::set(0, 1, 0, 0)), simd::mul(s.r, simd::set(0, 0, 1, 0)), simd::set(0, 0, 0, 1) } };
+	}
+
+	inline mat4 mat4_rotation_x(float angle)
+	{
+		float s = std::sin(angle), c = std::cos(angle);
+		return { { simd::set(1, 0, 0, 0), simd::set(0, c, s, 0), simd::set(0, -s, c, 0), simd::set(0, 0, 0, 1) } };
+	}
+
+	inline mat4 mat4_rotation_y(float angle)
+	{
+		float s = std::sin(angle), c = std::cos(angle);
+		return { { simd::set(c, 0, -s, 0), simd::set(0, 1, 0, 0), simd::set(s, 0, c, 0), simd::set(0, 0, 0, 1) } };
+	}
+
+	inline mat4 mat4_rotation_z(float angle)
+	{
+		float s = std::sin(angle), c = std::cos(angle);
+		return { { simd::set(c, s, 0, 0), simd::set(-s, c, 0, 0), simd::set(0, 0, 1, 0), simd::set(0, 0, 0, 1) } };
+	}
+
+	// Like XMMatrixLookAtLH, the result is a view matrix (world to camera)
+	inline mat4 mat4_look_at_lh(vec3 eye, vec3 focus, vec3 up)
+	{
+		vec3 z = normalize(focus - eye);
+		vec3 x = normalize(cross(up, z));
+		vec3 y = cross(z, x);
+
+		mat4 m = transpose({ { x.r, y.r, z.r, simd::set(0, 0, 0, 1) } });
+		m.r[3] = simd::set(-dot(x, eye), -dot(y, eye), -dot(z, eye), 1.0f);
+		return m;
+	}
+
+	// Like XMMatrixPerspectiveFovLH, depth maps to [0, 1]
+	inline mat4 mat4_perspective_fov_lh(float fov_y, float aspect, float near_z, float far_z)
+	{
+		float h = 1.0f / std::tan(fov_y * 0.5f);
+		float w = h / aspect;
+		float range = far_z / (far_z - near_z);
+		return { { simd::set(w, 0, 0, 0), simd::set(0, h, 0, 0), simd::set(0, 0, range, 1), simd::set(0, 0, -range * near_z, 0) } };
+	}
+
+	// quat //
+
+	inline quat quat_identity() { return { simd::set(0, 0, 0, 1) }; }
+
+	inline quat quat_axis_angle(vec3 axis, float angle)
+	{
+		float s = std::sin(angle * 0.5f);
+		vec3 n = normalize(axis);
+		return { simd::add(simd::mul(n.r, simd::splat(s)), simd::set(0, 0, 0, std::cos(angle * 0.5f))) };
+	}
+
+	inline quat conjugate(quat q) { return { simd::mul(q.r, simd::set(-1, -1, -1, 1)) }; }
+	inline float dot(quat a, quat b) { return simd::dot4(a.r, b.r); }
+	inline quat normalize(quat q) { return { simd::mul(q.r, simd::splat(1.0f / std::sqrt(dot(q, q)))) }; }
+
+	// a * b rotates by a first and then by b, like XMQuaternionMultiply
+	inline quat operator*(quat a, quat b)
+	{
+		float p[4], q[4];
+		simd::store(p, b.r);
+		simd::store(q, a.r);
+		return { simd::set(
+			p[3] * q[0] + p[0] * q[3] + p[1] * q[2] - p[2] * q[1],
+			p[3] * q[1] - p[0] * q[2] + p[1] * q[3] + p[2] * q[0],
+			p[3] * q[2] + p[0] * q[1] - p[1] * q[0] + p[2] * q[3],
+			p[3] * q[3] - p[0] * q[0] - p[1] * q[1] - p[2] * q[2]) };
+	}
+
+	inline vec3 rotate(vec3 v, quat q)
+	{
+		// v + 2w(u x v) + 2u x (u x v)
+		vec3 u = { simd::clear_w(q.r) };
+		vec3 t = cross(u, v) * 2.0f;
+		return v + t * simd::lane_x(simd::splat_lane<3>(q.r)) + cross(u, t);
+	}
+
+	inline quat slerp(quat a, quat b, float t)
+	{
+		float d = dot(a, b);
+		if (d < 0.0f)
+		{
+			b.r = simd::sub(simd::zero(), b.r);
+			d = -d;
+		}
+
+		// Nearly parallel, lerp is accurate and avoids dividing by sin(~0)
+		if (d > 0.9995f)
+			return normalize(quat{ simd::add(a.r, simd::mul(simd::sub(b.r, a.r), simd::splat(t))) });
+
+		float theta = std::acos(d);
+		float s = 1.0f / std::sin(theta);
+		float wa = std::sin((1.0f - t) * theta) * s;
+		float wb = std::sin(t * theta) * s;
+		return { simd::add(simd::mul(a.r, simd::splat(wa)), simd::mul(b.r, simd::splat(wb))) };
+	}
+
+	// Rotation matrix for row vectors, like XMMatrixRotationQuaternion
+	inline mat4 to_mat4(quat q)
+	{
+		float f[4];
+		simd::store(f, q.r);
+		float x = f[0], y = f[1], z = f[2], w = f[3];
+		return { {
+			simd::set(1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w), 0),
+			simd::set(2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w), 0),
+			simd::set(2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y), 0),
+			simd::set(0, 0, 0, 1) } };
+	}
+}
@@ -0,0 +1,508 @@
+#include "software_backend.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <emmintrin.h>
+
+#include "profiler.h"
+#include "shaders/cube_tables.hlsli"
+
+namespace end
+{
+	namespace
+	{
+		// Lines or triangles set up by one job, also the granularity of the bins
+		constexpr size_t SETUP_CHUNK_SIZE = 2048;
+
+		// Edge coefficients smaller than this don't bound a row's span
+		constexpr float SPAN_EPSILON = 1e-6f;
+
+		uint32_t pack_color(const float4& c)
+		{
+			auto channel = [](float v) { return (uint32_t)(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f); };
+			return channel(c.x) | (channel(c.y) << 8) | (channel(c.z) << 16) | 0xFF000000u;
+		}
+
+		float4 lerp(const float4& a, const float4& b, float t)
+		{
+			return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t, a.w + (b.w - a.w) * t };
+		}
+	}
+
+	software_backend_t::software_backend_t(uint32_t width, uint32_t height) : target_width(std::max(width, 1u)), target_height(std::max(height, 1u))
+	{
+		tiles_x = ((int)target_width + TILE_SIZE - 1) / TILE_SIZE;
+		tiles_y = ((int)target_height + TILE_SIZE - 1) / TILE_SIZE;
+		buffer_width = tiles_x * TILE_SIZE;
+		buffer_height = tiles_y * TILE_SIZE;
+
+		color.resize((size_t)buffer_width * buffer_height, clear_color);
+		depth.resize((size_t)buffer_width * buffer_height, 1.0f);
+	}
+
+	void software_backend_t::initialize(asset_loader_t&, job_system_t& job_system)
+	{
+		jobs = &job_system;
+	}
+
+	void software_backend_t::begin_frame(const float4& clear)
+	{
+		clear_color = pack_color(clear);
+		chunks_used = 0;
+	}
+
+	void software_backend_t::update_mvp(const MVP_t& mvp)
+	{
+		// Back to row vectors
+		world_view_proj = transpose(to_mat4(mvp.modeling)) * transpose(to_mat4(mvp.view)) * transpose(to_mat4(mvp.projection));
+	}
+
+	void software_backend_t::draw_cube()
+	{
+		PROFILE_SCOPE("raster setup");
+
+		// vs_cube.hlsl: 36 vertices from the index table, colored by their face normal
+		bin_chunk_t& chunk = next_chunk();
+		chunk.prims.clear();
+		for (uint32_t i = 0; i < 36; i += 3)
+		{
+			const float4& n = cube_tables::cube_n[i / 6];
+			float4 face_color = { (n.x + 1.0f) * 0.5f, (n.y + 1.0f) * 0.5f, (n.z + 1.0f) * 0.5f, 1.0f };
+
+			clip_vertex_t v[3];
+			for (int k = 0; k < 3; k++)
+				v[k] = { to_float4(to_vec4(cube_tables::cube_v[cube_tables::cube_i[i + k]]) * world_view_proj), face_color };
+
+			add_triangle(v[0], v[1], v[2], chunk);
+		}
+		bin(chunk);
+	}
+
+	void software_backend_t::draw_lines(const colored_vertex* verts, size_t vert_count)
+	{
+		PROFILE_SCOPE("raster setup");
+
+		size_t line_count = vert_count / 2;
+		if (line_count == 0)
+			return;
+
+		// Chunks are claimed up front, job i only touches chunk first + i
+		size_t first = chunks_used;
+		size_t count = (line_count + SETUP_CHUNK_SIZE - 1) / SETUP_CHUNK_SIZE;
+		if (chunks.size() < first + count)
+			chunks.resize(first + count);
+		chunks_used += count;
+
+		const mat4 m = world_view_proj;
+		run(line_count, SETUP_CHUNK_SIZE, [&](size_t first_line, size_t last_line)
+		{
+			bin_chunk_t& chunk = chunks[first + first_line / SETUP_CHUNK_SIZE];
+			chunk.prims.clear();
+			for (size_t i = first_line; i < last_line; i++)
+			{
+				const colored_vertex& a = verts[2 * i];
+				const colored_vertex& b = verts[2 * i + 1];
+				add_line({ to_float4(to_vec4(a.pos) * m), a.color }, { to_float4(to_vec4(b.pos) * m), b.color }, chunk);
+			}
+			bin(chunk);
+		});
+	}
+
+	void software_backend_t::present()
+	{
+		PROFILE_SCOPE("rasterize");
+
+		// A job per tile, each owns its pixels
+		run((size_t)tiles_x * tiles_y, 1, [this](size_t first, size_t last)
+		{
+			for (size_t t = first; t < last; t++)
+				rasterize_tile((int)t);
+		});
+	}
+
+	bool software_backend_t::write_ppm(const char* path, std::string* error)const
+	{
+		FILE* file = fopen(path, "wb");
+		if (!file)
+		{
+			if (error)
+				*error = std::string("can't open ") + path;
+			return false;
+		}
+
+		bool ok = fprintf(file, "P6\n%u %u\n255\n", target_width, target_height) > 0;
+
+		std::vector<uint8_t> row(target_width * 3);
+		for (uint32_t y = 0; y < target_height && ok; y++)
+		{
+			const uint32_t* src = &color[(size_t)y * buffer_width];
+			for (uint32_t x = 0; x < target_width; x++)
+			{
+				row[x * 3 + 0] = (uint8_t)(src[x]);
+				row[x * 3 + 1] = (uint8_t)(src[x] >> 8);
+				row[x * 3 + 2] = (uint8_t)(src[x] >> 16);
+			}
+			ok = fwrite(row.data(), 1, row.size(), file) == row.size();
+		}
+
+		if (fclose(file) != 0)
+			ok = false;
+		if (!ok && error)
+			*error = std::string("write failed: ") + path;
+		return ok;
+	}
+
+	size_t software_backend_t::primitive_count()const
+	{
+		size_t count = 0;
+		for (size_t i = 0; i < chunks_used; i++)
+			count += chunks[i].prims.size();
+		return count;
+	}
+
+	software_backend_t::bin_chunk_t& software_backend_t::next_chunk()
+	{
+		if (chunks.size() <= chunks_used)
+			chunks.resize(chunks_used + 1);
+		return chunks[chunks_used++];
+	}
+
+	void software_backend_t::run(size_t count, size_t chunk_size, const job_system_t::range_fn_t& fn)
+	{
+		if (jobs)
+		{
+			jobs->parallel_for(count, chunk_size, fn);
+			return;
+		}
+
+		for (size_t first = 0; first < count; first += chunk_size)
+			fn(first, std::min(first + chunk_size, count));
+	}
+
+	bool software_backend_t::setup_triangle(const clip_vertex_t& v0, const clip_vertex_t& v1, const clip_vertex_t& v2, raster_prim_t& out)const
+	{
+		const clip_vertex_t* v[3] = { &v0, &v1, &v2 };
+		float x[3], y[3], z[3];
+		for (int i = 0; i < 3; i++)
+		{
+			float inv_w = 1.0f / v[i]->pos.w;
+			x[i] = (v[i]->pos.x * inv_w * 0.5f + 0.5f) * target_width;
+			y[i] = (0.5f - v[i]->pos.y * inv_w * 0.5f) * target_height;
+			z[i] = v[i]->pos.z * inv_w;
+		}
+
+		// Clockwise on screen is front, with y down that's a positive area
+		float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+		if (!(area > 1e-8f))
+			return false;
+
+		out.min_x = std::max(0, (int)std::floor(std::max(std::min({ x[0], x[1], x[2] }), -1.0f)));
+		out.min_y = std::max(0, (int)std::floor(std::max(std::min({ y[0], y[1], y[2] }), -1.0f)));
+		out.max_x = std::min((int)target_width - 1, (int)std::ceil(std::min(std::max({ x[0], x[1], x[2] }), (float)target_width)));
+		out.max_y = std::min((int)target_height - 1, (int)std::ceil(std::min(std::max({ y[0], y[1], y[2] }), (float)target_height)));
+		if (out.min_x > out.max_x || out.min_y > out.max_y)
+			return false;
+
+		// Edge i is opposite vertex i, edge_i / area is vertex i's barycentric
+		for (int i = 0; i < 3; i++)
+		{
+			int j = (i + 1) % 3, k = (i + 2) % 3;
+			out.edge[i][0] = y[j] - y[k];
+			out.edge[i][1] = x[k] - x[j];
+			out.edge[i][2] = x[j] * y[k] - y[j] * x[k];
+		}
+		out.edge[3][0] = 0.0f;
+		out.edge[3][1] = 0.0f;
+		out.edge[3][2] = 1.0f;
+
+		float inv_area = 1.0f / area;
+		const float attributes[4][3] =
+		{
+			{ z[0], z[1], z[2] },
+			{ v0.color.x, v1.color.x, v2.color.x },
+			{ v0.color.y, v1.color.y, v2.color.y },
+			{ v0.color.z, v1.color.z, v2.color.z },
+		};
+		for (int p = 0; p < 4; p++)
+		{
+			for (int c = 0; c < 3; c++)
+				out.plane[p][c] = (out.edge[0][c] * attributes[p][0] + out.edge[1][c] * attributes[p][1] + out.edge[2][c] * attributes[p][2]) * inv_area;
+		}
+		return true;
+	}
+
+	bool software_backend_t::setup_line(const clip_vertex_t& v0, const clip_vertex_t& v1, raster_prim_t& out)const
+	{
+		float inv_w0 = 1.0f / v0.pos.w, inv_w1 = 1.0f / v1.pos.w;
+		float x0 = (v0.pos.x * inv_w0 * 0.5f + 0.5f) * target_width, y0 = (0.5f - v0.pos.y * inv_w0 * 0.5f) * target_height;
+		float x1 = (v1.pos.x * inv_w1 * 0.5f + 0.5f) * target_width, y1 = (0.5f - v1.pos.y * inv_w1 * 0.5f) * target_height;
+
+		out.min_x = std::max(0, (int)std::floor(std::max(std::min(x0, x1), 0.0f) - 1.0f));
+		out.min_y = std::max(0, (int)std::floor(std::max(std::min(y0, y1), 0.0f) - 1.0f));
+		out.max_x = std::min((int)target_width - 1, (int)std::ceil(std::min(std::max(x0, x1), (float)target_width) + 1.0f));
+		out.max_y = std::min((int)target_height - 1, (int)std::ceil(std::min(std::max(y0, y1), (float)target_height) + 1.0f));
+		if (out.min_x > out.max_x || out.min_y > out.max_y)
+			return false;
+
+		// One pixel wide quad around the segment, the ends stick out half a pixel so strips join
+		float dx = x1 - x0, dy = y1 - y0;
+		float len_sq = dx * dx + dy * dy;
+		float ux = 1.0f, uy = 0.0f, ta = 0.0f, tb = 0.0f, tc = 0.0f;
+		if (len_sq > 1e-12f)
+		{
+			float inv_len = 1.0f / std::sqrt(len_sq);
+			ux = dx * inv_len;
+			uy = dy * inv_len;
+			ta = dx / len_sq;
+			tb = dy / len_sq;
+			tc = -(dx * x0 + dy * y0) / len_sq;
+		}
+		float nx = -uy, ny = ux;
+
+		const float sides[4][3] =
+		{
+			{ nx, ny, 0.5f - (nx * x0 + ny * y0) },
+			{ -nx, -ny, 0.5f + (nx * x0 + ny * y0) },
+			{ ux, uy, 0.5f - (ux * x0 + uy * y0) },
+			{ -ux, -uy, 0.5f + (ux * x1 + uy * y1) },
+		};
+		std::copy(&sides[0][0], &sides[0][0] + 12, &out.edge[0][0]);
+
+		// Attributes go from v0 to v1 with t = dot(p - p0, d) / |d|^2
+		const float from[4] = { v0.pos.z * inv_w0, v0.color.x, v0.color.y, v0.color.z };
+		const float to[4] = { v1.pos.z * inv_w1, v1.color.x, v1.color.y, v1.color.z };
+		for (int p = 0; p < 4; p++)
+		{
+			float delta = to[p] - from[p];
+			out.plane[p][0] = ta * delta;
+			out.plane[p][1] = tb * delta;
+			out.plane[p][2] = from[p] + tc * delta;
+		}
+		return true;
+	}
+
+	void software_backend_t::add_triangle(clip_vertex_t v0, clip_vertex_t v1, clip_vertex_t v2, bin_chunk_t& chunk)const
+	{
+		// Clipped against the near plane (z >= 0) only, x/y are limited by the bounds and the
+		// edge functions and depth past the far plane fails the depth test
+		const clip_vertex_t in[3] = { v0, v1, v2 };
+		clip_vertex_t poly[4];
+		int count = 0;
+		for (int i = 0; i < 3; i++)
+		{
+			const clip_vertex_t& a = in[i];
+			const clip_vertex_t& b = in[(i + 1) % 3];
+			bool a_in = a.pos.z >= 0.0f, b_in = b.pos.z >= 0.0f;
+			if (a_in)
+				poly[count++] = a;
+			if (a_in != b_in)
+			{
+				float t = a.pos.z / (a.pos.z - b.pos.z);
+				poly[count++] = { lerp(a.pos, b.pos, t), lerp(a.color, b.color, t) };
+			}
+		}
+
+		raster_prim_t prim;
+		for (int i = 1; i + 1 < count; i++)
+		{
+			if (setup_triangle(poly[0], poly[i], poly[i + 1], prim))
+				chunk.prims.push_back(prim);
+		}
+	}
+
+	void software_backend_t::add_line(clip_vertex_t v0, clip_vertex_t v1, bin_chunk_t& chunk)const
+	{
+		bool in0 = v0.pos.z >= 0.0f, in1 = v1.pos.z >= 0.0f;
+		if (!in0 && !in1)
+			return;
+		if (!in0 || !in1)
+		{
+			float t = v0.pos.z / (v0.pos.z - v1.pos.z);
+			clip_vertex_t cut = { lerp(v0.pos, v1.pos, t), lerp(v0.color, v1.color, t) };
+			(in0 ? v1 : v0) = cut;
+		}
+
+		raster_prim_t prim;
+		if (setup_line(v0, v1, prim))
+			chunk.prims.push_back(prim);
+	}
+
+	void software_backend_t::bin(bin_chunk_t& chunk)const
+	{
+		chunk.pair_tiles.clear();
+		chunk.pair_prims.clear();
+
+		for (uint32_t i = 0; i < (uint32_t)chunk.prims.size(); i++)
+		{
+			const raster_prim_t& p = chunk.prims[i];
+			int tx0 = p.min_x / TILE_SIZE, tx1 = p.max_x / TILE_SIZE;
+			int ty0 = p.min_y / TILE_SIZE, ty1 = p.max_y / TILE_SIZE;
+			bool single = tx0 == tx1 && ty0 == ty1;
+
+			for (int ty = ty0; ty <= ty1; ty++)
+			{
+				float y_lo = ty * TILE_SIZE + 0.5f, y_hi = y_lo + TILE_SIZE - 1.0f;
+				for (int tx = tx0; tx <= tx1; tx++)
+				{
+					// Skipped if every pixel center of the tile is outside one edge,
+					// keeps long diagonal lines out of most tiles their bounds cover
+					if (!single)
+					{
+						float x_lo = tx * TILE_SIZE + 0.5f, x_hi = x_lo + TILE_SIZE - 1.0f;
+						bool outside = false;
+						for (int e = 0; e < 4 && !outside; e++)
+						{
+							const float* edge = p.edge[e];
+							float best = edge[0] * (edge[0] > 0.0f ? x_hi : x_lo) + edge[1] * (edge[1] > 0.0f ? y_hi : y_lo) + edge[2];
+							outside = best < 0.0f;
+						}
+						if (outside)
+							continue;
+					}
+
+					chunk.pair_tiles.push_back((uint32_t)(ty * tiles_x + tx));
+					chunk.pair_prims.push_back(i);
+				}
+			}
+		}
+
+		// Counting sort by tile, stable so each tile keeps the submission order
+		size_t tile_count = (size_t)tiles_x * tiles_y;
+		chunk.tile_start.assign(tile_count + 1, 0);
+		for (uint32_t t : chunk.pair_tiles)
+			chunk.tile_start[t + 1]++;
+		for (size_t t = 0; t < tile_count; t++)
+			chunk.tile_start[t + 1] += chunk.tile_start[t];
+
+		chunk.items.resize(chunk.pair_prims.size());
+		for (size_t i = 0; i < chunk.pair_prims.size(); i++)
+			chunk.items[chunk.tile_start[chunk.pair_tiles[i]]++] = chunk.pair_prims[i];
+
+		// The fill moved every start to the next tile's
+		for (size_t t = tile_count; t > 0; t--)
+			chunk.tile_start[t] = chunk.tile_start[t - 1];
+		chunk.tile_start[0] = 0;
+	}
+
+	void software_backend_t::rasterize_tile(int tile)
+	{
+		int x0 = (tile % tiles_x) * TILE_SIZE, y0 = (tile / tiles_x) * TILE_SIZE;
+		int x1 = x0 + TILE_SIZE - 1, y1 = y0 + TILE_SIZE - 1;
+
+		for (int y = y0; y <= y1; y++)
+		{
+			std::fill_n(&color[(size_t)y * buffer_width + x0], TILE_SIZE, clear_color);
+			std::fill_n(&depth[(size_t)y * buffer_width + x0], TILE_SIZE, 1.0f);
+		}
+
+		for (size_t c = 0; c < chunks_used; c++)
+		{
+			const bin_chunk_t& chunk = chunks[c];
+			if (chunk.tile_start.empty())
+				continue;
+
+			for (uint32_t i = chunk.tile_start[tile]; i < chunk.tile_start[tile + 1]; i++)
+				rasterize(chunk.prims[chunk.items[i]], x0, y0, x1, y1);
+		}
+	}
+
+	void software_backend_t::rasterize(const raster_prim_t& prim, int x0, int y0, int x1, int y1)
+	{
+		int min_x = std::max(prim.min_x, x0), max_x = std::min(prim.max_x, x1);
+		int min_y = std::max(prim.min_y, y0), max_y = std::min(prim.max_y, y1);
+		if (min_x > max_x || min_y > max_y)
+			return;
+
+		const __m128 lane_offsets = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 to_byte = _mm_set1_ps(255.0f);
+		const __m128i alpha = _mm_set1_epi32((int)0xFF000000u);
+
+		// The 4 edges side by side. Pixel x of a row is inside edge k where
+		// a*(x + 0.5) + row >= 0, so x >= -row/a - 0.5 for a > 0 and x <= that for a < 0.
+		// A shared edge has the same bound from both sides, so spans don't leave gaps.
+		const __m128 edge_a = _mm_set_ps(prim.edge[3][0], prim.edge[2][0], prim.edge[1][0], prim.edge[0][0]);
+		const __m128 edge_b = _mm_set_ps(prim.edge[3][1], prim.edge[2][1], prim.edge[1][1], prim.edge[0][1]);
+		const __m128 edge_c = _mm_set_ps(prim.edge[3][2], prim.edge[2][2], prim.edge[1][2], prim.edge[0][2]);
+		const __m128 lower = _mm_cmpgt_ps(edge_a, _mm_set1_ps(SPAN_EPSILON));
+		const __m128 upper = _mm_cmplt_ps(edge_a, _mm_set1_ps(-SPAN_EPSILON));
+		const __m128 flat = _mm_andnot_ps(_mm_or_ps(lower, upper), _mm_castsi128_ps(_mm_set1_epi32(-1)));
+		const __m128 neg_inv_a = _mm_andnot_ps(flat, _mm_div_ps(_mm_set1_ps(-1.0f), edge_a));
+		const __m128 no_lower = _mm_set1_ps((float)min_x);
+		const __m128 no_upper = _mm_set1_ps((float)max_x);
+
+		__m128 plane_a[4];
+		for (int k = 0; k < 4; k++)
+			plane_a[k] = _mm_set1_ps(prim.plane[k][0]);
+
+		float py = min_y + 0.5f;
+		__m128 row = _mm_add_ps(_mm_mul_ps(edge_b, _mm_set1_ps(py)), edge_c);
+
+		for (int y = min_y; y <= max_y; y++, py += 1.0f, row = _mm_add_ps(row, edge_b))
+		{
+			// A flat edge keeps the whole row in or out
+			if (_mm_movemask_ps(_mm_and_ps(flat, _mm_cmplt_ps(row, zero))))
+				continue;
+
+			__m128 bound = _mm_sub_ps(_mm_mul_ps(row, neg_inv_a), half);
+			__m128 lo = _mm_max_ps(_mm_or_ps(_mm_and_ps(lower, bound), _mm_andnot_ps(lower, no_lower)), no_lower);
+			__m128 hi = _mm_min_ps(_mm_or_ps(_mm_and_ps(upper, bound), _mm_andnot_ps(upper, no_upper)), no_upper);
+			lo = _mm_max_ps(lo, _mm_shuffle_ps(lo, lo, _MM_SHUFFLE(1, 0, 3, 2)));
+			lo = _mm_max_ps(lo, _mm_shuffle_ps(lo, lo, _MM_SHUFFLE(2, 3, 0, 1)));
+			hi = _mm_min_ps(hi, _mm_shuffle_ps(hi, hi, _MM_SHUFFLE(1, 0, 3, 2)));
+			hi = _mm_min_ps(hi, _mm_shuffle_ps(hi, hi, _MM_SHUFFLE(2, 3, 0, 1)));
+
+			float span_lo = _mm_cvtss_f32(lo), span_hi = _mm_cvtss_f32(hi);
+			if (!(span_lo <= span_hi))
+				continue;
+
+			// Both are >= min_x >= 0 here, so truncating is floor. 4 pixel groups, tiles are a
+			// multiple of 4 wide so they never leave the tile
+			int first = (int)span_lo & ~3;
+			int last = (int)span_hi;
+
+			__m128 plane_row[4];
+			for (int k = 0; k < 4; k++)
+				plane_row[k] = _mm_set1_ps(prim.plane[k][1] * py + prim.plane[k][2]);
+
+			float* depth_row = &depth[(size_t)y * buffer_width];
+			uint32_t* color_row = &color[(size_t)y * buffer_width];
+
+			for (int x = first; x <= last; x += 4)
+			{
+				__m128 xs = _mm_add_ps(_mm_set1_ps((float)x), lane_offsets);
+				__m128 inside = _mm_and_ps(_mm_cmpge_ps(xs, lo), _mm_cmple_ps(xs, hi));
+
+				__m128 px = _mm_add_ps(xs, half);
+				__m128 z = _mm_max_ps(_mm_add_ps(_mm_mul_ps(plane_a[0], px), plane_row[0]), zero);
+				__m128 old_z = _mm_loadu_ps(depth_row + x);
+				__m128 pass = _mm_and_ps(inside, _mm_cmple_ps(z, old_z));
+				if (_mm_movemask_ps(pass) == 0)
+					continue;
+
+				_mm_storeu_ps(depth_row + x, _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, old_z)));
+
+				__m128i rgba = alpha;
+				for (int k = 1; k < 4; k++)
+				{
+					__m128 c = _mm_add_ps(_mm_mul_ps(plane_a[k], px), plane_row[k]);
+					c = _mm_min_ps(_mm_max_ps(c, zero), one);
+					__m128i channel = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(c, to_byte), half));
+					rgba = _mm_or_si128(rgba, _mm_slli_epi32(channel, 8 * (k - 1)));
+				}
+
+				__m128i mask = _mm_castps_si128(pass);
+				__m128i old_color = _mm_loadu_si128((const __m128i*)(color_row + x));
+				_mm_storeu_si128((__m128i*)(color_row + x), _mm_or_si128(_mm_and_si128(mask, rgba), _mm_andnot_si128(mask, old_color)));
+			}
+		}
+	}
+
+	std::unique_ptr<render_backend_t> create_software_backend(uint32_t width, uint32_t height)
+	{
+		return std::unique_ptr<render_backend_t>(new software_backend_t(width, height));
+	}
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "job_system.h"
+#include "render_backend.h"
+#include "simd_math.h"
+
+namespace end
+{
+	// CPU backend that renders into memory, for images from headless runs.
+	//
+	//	Same pipeline as the D3D11 one: vs_cube.hlsl / debug_line_vs.hlsl transforms, back faces
+	//	culled (clockwise is front), depth test less-equal, lines one pixel wide.
+	//	Draw calls transform, clip against the near plane and set up their primitives right away,
+	//	in chunks on the job system. Every chunk bins its primitives into its own lists per screen
+	//	tile, so present() can rasterize all tiles in parallel with each tile reading its chunks in
+	//	submission order: no locks, and the image doesn't depend on the thread count.
+	//	Pixels are 4 at a time with SSE edge functions, only over each row's span of the primitive.
+	//	Colors are RGBA8 (R in the low byte), depth is z/w as a float.
+	class software_backend_t final : public render_backend_t
+	{
+	public:
+
+		static constexpr int TILE_SIZE = 32;
+
+		software_backend_t(uint32_t width = 1280, uint32_t height = 720);
+
+		void initialize(asset_loader_t& assets, job_system_t& jobs) override;
+
+		float width()const override { return (float)target_width; }
+		float height()const override { return (float)target_height; }
+
+		void begin_frame(const float4& clear_color) override;
+		void update_mvp(const MVP_t& mvp) override;
+		void draw_cube() override;
+		void draw_lines(const colored_vertex* verts, size_t vert_count) override;
+
+		// Rasterizes the frame, the targets hold it until the next present
+		void present() override;
+
+		// Rows of pitch() pixels, the image is the top left width() x height()
+		const uint32_t* color_data()const { return color.data(); }
+		const float* depth_data()const { return depth.data(); }
+		size_t pitch()const { return (size_t)buffer_width; }
+
+		// Binary PPM (P6) of the last presented frame, false with a message in error if it can't be written
+		bool write_ppm(const char* path, std::string* error = nullptr)const;
+
+		// Primitives set up for the current frame, after clipping and culling
+		size_t primitive_count()const;
+
+		// Without initialize() everything runs on the calling thread
+		void set_job_system(job_system_t* job_system) { jobs = job_system; }
+
+	private:
+
+		// Triangle or line quad, as up to 4 edge functions e = a*x + b*y + c (inside where all >= 0)
+		// and planes for the interpolated depth and color
+		struct raster_prim_t
+		{
+			float edge[4][3];
+			float plane[4][3];	// z, r, g, b
+			int min_x, min_y, max_x, max_y;
+		};
+
+		// Primitives from one slice of a draw, binned by tile
+		struct bin_chunk_t
+		{
+			std::vector<raster_prim_t> prims;
+			std::vector<uint32_t> tile_start;	// tile t is items [tile_start[t], tile_start[t + 1])
+			std::vector<uint32_t> items;		// indices into prims
+			std::vector<uint32_t> pair_tiles;	// scratch for binning
+			std::vector<uint32_t> pair_prims;
+		};
+
+		struct clip_vertex_t
+		{
+			float4 pos;
+			float4 color;
+		};
+
+		bin_chunk_t& next_chunk();
+		void run(size_t count, size_t chunk_size, const job_system_t::range_fn_t& fn);
+
+		bool setup_triangle(const clip_vertex_t& v0, const clip_vertex_t& v1, const clip_vertex_t& v2, raster_prim_t& out)const;
+		bool setup_line(const clip_vertex_t& v0, const clip_vertex_t& v1, raster_prim_t& out)const;
+		void add_triangle(clip_vertex_t v0, clip_vertex_t v1, clip_vertex_t v2, bin_chunk_t& chunk)const;
+		void add_line(clip_vertex_t v0, clip_vertex_t v1, bin_chunk_t& chunk)const;
+		void bin(bin_chunk_t& chunk)const;
+
+		void rasterize_tile(int tile);
+		void rasterize(const raster_prim_t& prim, int x0, int y0, int x1, int y1);
+
+		uint32_t target_width;
+		uint32_t target_height;
+		int buffer_width;
+		int buffer_height;
+		int tiles_x;
+		int tiles_y;
+
+		std::vector<uint32_t> color;
+		std::vector<float> depth;
+		uint32_t clear_color = 0xFF000000;
+
+		mat4 world_view_proj = mat4_identity();
+
+		std::vector<bin_chunk_t> chunks;	// kept between frames for their capacity
+		size_t chunks_used = 0;
+
+		job_system_t* jobs = nullptr;
+	};
+}
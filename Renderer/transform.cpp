@@ -0,0 +1,278 @@
+#include "transform.h"
+
+#include <cmath>
+#include <immintrin.h>
+
+#include "cpu_features.h"
+
+// GCC/Clang only allow AVX2 intrinsics in functions built for it, MSVC always does
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TARGET_AVX2_FMA
+#else
+#define TARGET_AVX2_FMA __attribute__((target("avx2,fma")))
+#endif
+
+namespace end
+{
+	namespace
+	{
+		bool use_avx2()
+		{
+			static const bool avx2 = cpu_features().avx2 && cpu_features().fma;
+			return avx2;
+		}
+
+		void transform_point_scalar(float x, float y, float z, const float4x4_a& m, float& ox, float& oy, float& oz)
+		{
+			ox = x * m[0].x + y * m[1].x + z * m[2].x + m[3].x;
+			oy = x * m[0].y + y * m[1].y + z * m[2].y + m[3].y;
+			oz = x * m[0].z + y * m[1].z + z * m[2].z + m[3].z;
+		}
+
+		// SSE //
+
+		size_t transform_points_soa_sse(const float* in_x, const float* in_y, const float* in_z, size_t count, const float4x4_a& m,
+			float* out_x, float* out_y, float* out_z)
+		{
+			__m128 m00 = _mm_set1_ps(m[0].x), m01 = _mm_set1_ps(m[0].y), m02 = _mm_set1_ps(m[0].z);
+			__m128 m10 = _mm_set1_ps(m[1].x), m11 = _mm_set1_ps(m[1].y), m12 = _mm_set1_ps(m[1].z);
+			__m128 m20 = _mm_set1_ps(m[2].x), m21 = _mm_set1_ps(m[2].y), m22 = _mm_set1_ps(m[2].z);
+			__m128 m30 = _mm_set1_ps(m[3].x), m31 = _mm_set1_ps(m[3].y), m32 = _mm_set1_ps(m[3].z);
+
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128 x = _mm_loadu_ps(in_x + i), y = _mm_loadu_ps(in_y + i), z = _mm_loadu_ps(in_z + i);
+				_mm_storeu_ps(out_x + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m00), _mm_mul_ps(y, m10)), _mm_add_ps(_mm_mul_ps(z, m20), m30)));
+				_mm_storeu_ps(out_y + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m01), _mm_mul_ps(y, m11)), _mm_add_ps(_mm_mul_ps(z, m21), m31)));
+				_mm_storeu_ps(out_z + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m02), _mm_mul_ps(y, m12)), _mm_add_ps(_mm_mul_ps(z, m22), m32)));
+			}
+			return i;
+		}
+
+		size_t transform_aabbs_sse(const aabb_soa_view_t& in, const float4x4_a& m, aabb_soa_t& out)
+		{
+			const __m128 half = _mm_set1_ps(0.5f);
+			const __m128 sign_mask = _mm_set1_ps(-0.0f);
+
+			__m128 r[3][3], a[3][3], t[3];
+			for (int row = 0; row < 3; row++)
+			{
+				for (int col = 0; col < 3; col++)
+				{
+					r[row][col] = _mm_set1_ps(m[row][col]);
+					a[row][col] = _mm_andnot_ps(sign_mask, r[row][col]);
+				}
+			}
+			for (int col = 0; col < 3; col++)
+				t[col] = _mm_set1_ps(m[3][col]);
+
+			const float* in_min[3] = { in.min_x, in.min_y, in.min_z };
+			const float* in_max[3] = { in.max_x, in.max_y, in.max_z };
+			float* out_min[3] = { out.min_x.data(), out.min_y.data(), out.min_z.data() };
+			float* out_max[3] = { out.max_x.data(), out.max_y.data(), out.max_z.data() };
+
+			size_t i = 0;
+			for (; i + 4 <= in.count; i += 4)
+			{
+				__m128 c[3], e[3];
+				for (int axis = 0; axis < 3; axis++)
+				{
+					__m128 mn = _mm_loadu_ps(in_min[axis] + i), mx = _mm_loadu_ps(in_max[axis] + i);
+					c[axis] = _mm_mul_ps(_mm_add_ps(mn, mx), half);
+					e[axis] = _mm_mul_ps(_mm_sub_ps(mx, mn), half);
+				}
+
+				for (int col = 0; col < 3; col++)
+				{
+					__m128 nc = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c[0], r[0][col]), _mm_mul_ps(c[1], r[1][col])), _mm_add_ps(_mm_mul_ps(c[2], r[2][col]), t[col]));
+					__m128 ne = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e[0], a[0][col]), _mm_mul_ps(e[1], a[1][col])), _mm_mul_ps(e[2], a[2][col]));
+					_mm_storeu_ps(out_min[col] + i, _mm_sub_ps(nc, ne));
+					_mm_storeu_ps(out_max[col] + i, _mm_add_ps(nc, ne));
+				}
+			}
+			return i;
+		}
+
+		inline __m128 multiply_row_sse(__m128 row, __m128 b0, __m128 b1, __m128 b2, __m128 b3)
+		{
+			__m128 out = _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+			out = _mm_add_ps(out, _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(1, 1, 1, 1)), b1));
+			out = _mm_add_ps(out, _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(2, 2, 2, 2)), b2));
+			return _mm_add_ps(out, _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(3, 3, 3, 3)), b3));
+		}
+
+		void multiply_matrix_sse(const float4x4_a& a, const float4x4_a& b, float4x4_a& out)
+		{
+			__m128 b0 = _mm_load_ps(b[0].data()), b1 = _mm_load_ps(b[1].data()), b2 = _mm_load_ps(b[2].data()), b3 = _mm_load_ps(b[3].data());
+			__m128 rows[4];
+			for (int r = 0; r < 4; r++)
+				rows[r] = multiply_row_sse(_mm_load_ps(a[r].data()), b0, b1, b2, b3);
+
+			// Stored after all rows are read so out can alias a or b
+			for (int r = 0; r < 4; r++)
+				_mm_store_ps(out[r].data(), rows[r]);
+		}
+
+		// AVX2 + FMA //
+
+		TARGET_AVX2_FMA size_t transform_points_soa_avx2(const float* in_x, const float* in_y, const float* in_z, size_t count, const float4x4_a& m,
+			float* out_x, float* out_y, float* out_z)
+		{
+			__m256 m00 = _mm256_set1_ps(m[0].x), m01 = _mm256_set1_ps(m[0].y), m02 = _mm256_set1_ps(m[0].z);
+			__m256 m10 = _mm256_set1_ps(m[1].x), m11 = _mm256_set1_ps(m[1].y), m12 = _mm256_set1_ps(m[1].z);
+			__m256 m20 = _mm256_set1_ps(m[2].x), m21 = _mm256_set1_ps(m[2].y), m22 = _mm256_set1_ps(m[2].z);
+			__m256 m30 = _mm256_set1_ps(m[3].x), m31 = _mm256_set1_ps(m[3].y), m32 = _mm256_set1_ps(m[3].z);
+
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256 x = _mm256_loadu_ps(in_x + i), y = _mm256_loadu_ps(in_y + i), z = _mm256_loadu_ps(in_z + i);
+				_mm256_storeu_ps(out_x + i, _mm256_fmadd_ps(x, m00, _mm256_fmadd_ps(y, m10, _mm256_fmadd_ps(z, m20, m30))));
+				_mm256_storeu_ps(out_y + i, _mm256_fmadd_ps(x, m01, _mm256_fmadd_ps(y, m11, _mm256_fmadd_ps(z, m21, m31))));
+				_mm256_storeu_ps(out_z + i, _mm256_fmadd_ps(x, m02, _mm256_fmadd_ps(y, m12, _mm256_fmadd_ps(z, m22, m32))));
+			}
+			return i;
+		}
+
+		TARGET_AVX2_FMA size_t transform_aabbs_avx2(const aabb_soa_view_t& in, const float4x4_a& m, aabb_soa_t& out)
+		{
+			const __m256 half = _mm256_set1_ps(0.5f);
+			const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+
+			__m256 r[3][3], a[3][3], t[3];
+			for (int row = 0; row < 3; row++)
+			{
+				for (int col = 0; col < 3; col++)
+				{
+					r[row][col] = _mm256_set1_ps(m[row][col]);
+					a[row][col] = _mm256_andnot_ps(sign_mask, r[row][col]);
+				}
+			}
+			for (int col = 0; col < 3; col++)
+				t[col] = _mm256_set1_ps(m[3][col]);
+
+			const float* in_min[3] = { in.min_x, in.min_y, in.min_z };
+			const float* in_max[3] = { in.max_x, in.max_y, in.max_z };
+			float* out_min[3] = { out.min_x.data(), out.min_y.data(), out.min_z.data() };
+			float* out_max[3] = { out.max_x.data(), out.max_y.data(), out.max_z.data() };
+
+			size_t i = 0;
+			for (; i + 8 <= in.count; i += 8)
+			{
+				__m256 c[3], e[3];
+				for (int axis = 0; axis < 3; axis++)
+				{
+					__m256 mn = _mm256_loadu_ps(in_min[axis] + i), mx = _mm256_loadu_ps(in_max[axis] + i);
+					c[axis] = _mm256_mul_ps(_mm256_add_ps(mn, mx), half);
+					e[axis] = _mm256_mul_ps(_mm256_sub_ps(mx, mn), half);
+				}
+
+				for (int col = 0; col < 3; col++)
+				{
+					__m256 nc = _mm256_fmadd_ps(c[0], r[0][col], _mm256_fmadd_ps(c[1], r[1][col], _mm256_fmadd_ps(c[2], r[2][col], t[col])));
+					__m256 ne = _mm256_fmadd_ps(e[0], a[0][col], _mm256_fmadd_ps(e[1], a[1][col], _mm256_mul_ps(e[2], a[2][col])));
+					_mm256_storeu_ps(out_min[col] + i, _mm256_sub_ps(nc, ne));
+					_mm256_storeu_ps(out_max[col] + i, _mm256_add_ps(nc, ne));
+				}
+			}
+			return i;
+		}
+
+		// Two rows of a per register, the b rows are broadcast to both halves
+		TARGET_AVX2_FMA inline __m256 multiply_rows_avx2(__m256 rows, __m256 b0, __m256 b1, __m256 b2, __m256 b3)
+		{
+			__m256 out = _mm256_mul_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+			out = _mm256_fmadd_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(1, 1, 1, 1)), b1, out);
+			out = _mm256_fmadd_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(2, 2, 2, 2)), b2, out);
+			return _mm256_fmadd_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(3, 3, 3, 3)), b3, out);
+		}
+
+		TARGET_AVX2_FMA void multiply_matrices_avx2(const float4x4_a* a, const float4x4_a* b, size_t b_stride, size_t count, float4x4_a* out)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				const float4x4_a& bm = b[i * b_stride];
+				__m256 b0 = _mm256_broadcast_ps((const __m128*)bm[0].data());
+				__m256 b1 = _mm256_broadcast_ps((const __m128*)bm[1].data());
+				__m256 b2 = _mm256_broadcast_ps((const __m128*)bm[2].data());
+				__m256 b3 = _mm256_broadcast_ps((const __m128*)bm[3].data());
+
+				__m256 r01 = multiply_rows_avx2(_mm256_loadu_ps(a[i][0].data()), b0, b1, b2, b3);
+				__m256 r23 = multiply_rows_avx2(_mm256_loadu_ps(a[i][2].data()), b0, b1, b2, b3);
+				_mm256_storeu_ps(out[i][0].data(), r01);
+				_mm256_storeu_ps(out[i][2].data(), r23);
+			}
+		}
+	}
+
+	void transform_points(const float3* in, size_t count, const float4x4_a& m, float4* out)
+	{
+		__m128 r0 = _mm_load_ps(m[0].data()), r1 = _mm_load_ps(m[1].data()), r2 = _mm_load_ps(m[2].data()), r3 = _mm_load_ps(m[3].data());
+		for (size_t i = 0; i < count; i++)
+		{
+			__m128 p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(in[i].x), r0), _mm_mul_ps(_mm_set1_ps(in[i].y), r1)), _mm_add_ps(_mm_mul_ps(_mm_set1_ps(in[i].z), r2), r3));
+			_mm_storeu_ps(out[i].data(), p);
+		}
+	}
+
+	void transform_points_soa(const float* in_x, const float* in_y, const float* in_z, size_t count, const float4x4_a& m,
+		float* out_x, float* out_y, float* out_z)
+	{
+		size_t i = use_avx2() ?
+			transform_points_soa_avx2(in_x, in_y, in_z, count, m, out_x, out_y, out_z) :
+			transform_points_soa_sse(in_x, in_y, in_z, count, m, out_x, out_y, out_z);
+
+		for (; i < count; i++)
+			transform_point_scalar(in_x[i], in_y[i], in_z[i], m, out_x[i], out_y[i], out_z[i]);
+	}
+
+	void multiply_matrices(const float4x4_a* a, const float4x4_a* b, size_t count, float4x4_a* out)
+	{
+		if (use_avx2())
+			multiply_matrices_avx2(a, b, 1, count, out);
+		else
+		{
+			for (size_t i = 0; i < count; i++)
+				multiply_matrix_sse(a[i], b[i], out[i]);
+		}
+	}
+
+	void multiply_matrices(const float4x4_a* a, const float4x4_a& b, size_t count, float4x4_a* out)
+	{
+		// Copy in case out overlaps b
+		const float4x4_a bm = b;
+		if (use_avx2())
+			multiply_matrices_avx2(a, &bm, 0, count, out);
+		else
+		{
+			for (size_t i = 0; i < count; i++)
+				multiply_matrix_sse(a[i], bm, out[i]);
+		}
+	}
+
+	aabb_t transform_aabb(const aabb_t& box, const float4x4_a& m)
+	{
+		float3 c = box.center();
+		float3 e = box.extents();
+
+		aabb_t rtn;
+		for (int col = 0; col < 3; col++)
+		{
+			float nc = c.x * m[0][col] + c.y * m[1][col] + c.z * m[2][col] + m[3][col];
+			float ne = e.x * std::fabs(m[0][col]) + e.y * std::fabs(m[1][col]) + e.z * std::fabs(m[2][col]);
+			rtn.min[col] = nc - ne;
+			rtn.max[col] = nc + ne;
+		}
+		return rtn;
+	}
+
+	void transform_aabbs(const aabb_soa_view_t& in, const float4x4_a& m, aabb_soa_t& out)
+	{
+		out.resize(in.count);
+
+		size_t i = use_avx2() ? transform_aabbs_avx2(in, m, out) : transform_aabbs_sse(in, m, out);
+		for (; i < in.count; i++)
+			out.set(i, transform_aabb(in.get(i), m));
+	}
+}
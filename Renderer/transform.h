@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+
+#include "bounds.h"
+
+namespace end
+{
+	// Batched transforms, one matrix (or matrix pair) for many elements.
+	//
+	//	Row vectors like the rest of the renderer: p * m.
+	//	The SoA kernels run 8 wide with AVX2/FMA when the CPU has it (checked at runtime)
+	//	and 4 wide with SSE otherwise. Outputs may alias the matching inputs.
+
+	// out[i] = (in[i], 1) * m
+	void transform_points(const float3* in, size_t count, const float4x4_a& m, float4* out);
+
+	// Affine: out = (in, 1) * m without the w row/divide
+	void transform_points_soa(const float* in_x, const float* in_y, const float* in_z, size_t count, const float4x4_a& m,
+		float* out_x, float* out_y, float* out_z);
+
+	// out[i] = a[i] * b[i]
+	void multiply_matrices(const float4x4_a* a, const float4x4_a* b, size_t count, float4x4_a* out);
+
+	// out[i] = a[i] * b, e.g. every world matrix by the same view projection
+	void multiply_matrices(const float4x4_a* a, const float4x4_a& b, size_t count, float4x4_a* out);
+
+	// Box enclosing the transformed box (Arvo): center by m, extents by |m|, m affine
+	aabb_t transform_aabb(const aabb_t& box, const float4x4_a& m);
+
+	// out is resized to in.count
+	void transform_aabbs(const aabb_soa_view_t& in, const float4x4_a& m, aabb_soa_t& out);
+}
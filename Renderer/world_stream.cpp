@@ -0,0 +1,323 @@
+#include "world_stream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "profiler.h"
+
+namespace end
+{
+	namespace
+	{
+		constexpr size_t PAGE_SIZE = 4096;
+		constexpr float VELOCITY_SMOOTHING = 0.25f;	// share of this frame's velocity in the estimate
+		constexpr float LOAD_WATERMARK = 0.9f;		// share of the budget new cells can fill without evicting
+
+		uint64_t cell_key(int32_t x, int32_t z)
+		{
+			return ((uint64_t)(uint32_t)x << 32) | (uint32_t)z;
+		}
+
+		// Distance on the XZ plane from p to the cell's square, 0 inside
+		float cell_distance(const float3& p, int32_t x, int32_t z, float cell_size)
+		{
+			float x0 = x * cell_size, z0 = z * cell_size;
+			float dx = std::max(std::max(x0 - p.x, p.x - (x0 + cell_size)), 0.0f);
+			float dz = std::max(std::max(z0 - p.z, p.z - (z0 + cell_size)), 0.0f);
+			return std::sqrt(dx * dx + dz * dz);
+		}
+
+		// Reads one byte per page
+		void touch_pages(const void* data, size_t size)
+		{
+			volatile uint8_t sink = 0;
+			const uint8_t* bytes = (const uint8_t*)data;
+			for (size_t i = 0; i < size; i += PAGE_SIZE)
+				sink = sink + bytes[i];
+		}
+	}
+
+	std::string world_cell_path(const std::string& directory, int32_t x, int32_t z)
+	{
+		char name[64];
+		snprintf(name, sizeof(name), "cell_%d_%d.bin", (int)x, (int)z);
+		return directory.empty() ? std::string(name) : directory + "/" + name;
+	}
+
+	int32_t world_cell_coord(float position, float cell_size)
+	{
+		return (int32_t)std::floor(position / cell_size);
+	}
+
+	world_streamer_t::world_streamer_t(const world_stream_settings_t& settings) : config(settings)
+	{
+		if (config.cell_size <= 0.0f)
+			config.cell_size = 64.0f;
+		config.unload_radius = std::max(config.unload_radius, config.load_radius);
+		config.max_in_flight = std::max<size_t>(config.max_in_flight, 1);
+
+		int thread_count = std::max(config.io_threads, 1);
+		for (int i = 0; i < thread_count; i++)
+			io_threads.emplace_back(&world_streamer_t::io_loop, this);
+	}
+
+	world_streamer_t::~world_streamer_t()
+	{
+		{
+			std::lock_guard<std::mutex> guard(queue_lock);
+			quit = true;
+		}
+		request_ready.notify_all();
+
+		for (std::thread& t : io_threads)
+			t.join();
+	}
+
+	void world_streamer_t::update(const float3& position, float dt)
+	{
+		PROFILE_SCOPE("stream cells");
+
+		if (!has_position)
+			velocity = { 0.0f, 0.0f, 0.0f };
+		else if (dt > 0.0f)
+			velocity += ((position - last_position) * (1.0f / dt) - velocity) * VELOCITY_SMOOTHING;
+		last_position = position;
+		has_position = true;
+
+		float3 predicted = position + velocity * config.prefetch_seconds;
+		float cs = config.cell_size;
+
+		collect_finished();
+
+		// Around the camera, then around where it's heading. Prefetched cells rank a cell behind
+		// cells at the same distance from the camera.
+		wanted.clear();
+		gather_wanted(position, config.load_radius, 0.0f, wanted);
+		gather_wanted(predicted, config.load_radius, cs, wanted);
+
+		std::sort(wanted.begin(), wanted.end(), [](const wanted_t& a, const wanted_t& b)
+			{ return a.key != b.key ? a.key < b.key : a.distance < b.distance; });
+		wanted.erase(std::unique(wanted.begin(), wanted.end(), [](const wanted_t& a, const wanted_t& b) { return a.key == b.key; }),
+			wanted.end());
+		std::sort(wanted.begin(), wanted.end(), [](const wanted_t& a, const wanted_t& b)
+			{ return a.distance != b.distance ? a.distance < b.distance : a.key < b.key; });
+
+		// Resident cells ranked the same way, past unload_radius they go
+		std::vector<uint64_t> out_of_range;
+		for (auto& it : cells)
+		{
+			cell_t& c = it.second->cell;
+			c.distance = std::min(cell_distance(position, c.x, c.z, cs), cell_distance(predicted, c.x, c.z, cs) + cs);
+			if (it.second->resident && c.distance > config.unload_radius)
+				out_of_range.push_back(it.first);
+		}
+		for (uint64_t key : out_of_range)
+			evict(key, false);
+
+		// Loads finished over the estimate can leave the budget exceeded, drop the farthest
+		while (counters.resident_bytes > config.memory_budget)
+		{
+			uint64_t victim = 0;
+			float farthest = -1.0f;
+			for (auto& it : cells)
+			{
+				if (it.second->resident && it.second->cell.distance > farthest)
+				{
+					farthest = it.second->cell.distance;
+					victim = it.first;
+				}
+			}
+			if (farthest < 0.0f)
+				break;
+			evict(victim, true);
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(queue_lock);
+
+			// Rebuilt nearest first, queued cells that aren't wanted anymore are dropped
+			requests.clear();
+
+			size_t average = counters.resident_cells ? counters.resident_bytes / counters.resident_cells : 0;
+			size_t watermark = (size_t)(config.memory_budget * LOAD_WATERMARK);
+
+			for (const wanted_t& w : wanted)
+			{
+				auto found = cells.find(w.key);
+				if (found != cells.end())
+				{
+					slot_t* slot = found->second.get();
+					if (slot->state == CELL_QUEUED && requests.size() + loading < config.max_in_flight)
+						requests.push_back(slot);
+					continue;
+				}
+
+				if (requests.size() + loading >= config.max_in_flight)
+					break;
+
+				// Over the watermark a new cell replaces a farther resident one or doesn't load
+				size_t expected = counters.resident_bytes + (requests.size() + loading + 1) * average;
+				if (expected > watermark)
+				{
+					uint64_t victim = 0;
+					float farthest = w.distance;
+					for (auto& it : cells)
+					{
+						if (it.second->resident && it.second->cell.distance > farthest)
+						{
+							farthest = it.second->cell.distance;
+							victim = it.first;
+						}
+					}
+					if (farthest == w.distance)
+						break;
+					evict(victim, true);
+				}
+
+				std::unique_ptr<slot_t> slot(new slot_t);
+				slot->cell.x = w.x;
+				slot->cell.z = w.z;
+				slot->cell.distance = w.distance;
+				requests.push_back(slot.get());
+				cells.emplace(w.key, std::move(slot));
+			}
+
+			for (auto it = cells.begin(); it != cells.end();)
+			{
+				slot_t* slot = it->second.get();
+				bool requested = std::find(requests.begin(), requests.end(), slot) != requests.end();
+				if (slot->state == CELL_QUEUED && !requested)
+					it = cells.erase(it);
+				else
+					++it;
+			}
+
+			counters.in_flight = requests.size() + loading;
+		}
+		request_ready.notify_all();
+
+		ready.clear();
+		for (auto& it : cells)
+		{
+			const cell_t& c = it.second->cell;
+			if (it.second->resident && c.scene.is_open() && c.scene.object_count() > 0)
+				ready.push_back(&c);
+		}
+		std::sort(ready.begin(), ready.end(), [](const cell_t* a, const cell_t* b)
+			{ return a->distance != b->distance ? a->distance < b->distance : cell_key(a->x, a->z) < cell_key(b->x, b->z); });
+	}
+
+	void world_streamer_t::flush(const float3& position)
+	{
+		for (;;)
+		{
+			update(position, 0.0f);
+
+			std::unique_lock<std::mutex> lock(queue_lock);
+			if (requests.empty() && loading == 0 && finished.empty())
+				return;
+
+			load_finished.wait(lock, [this] { return requests.empty() && loading == 0; });
+		}
+	}
+
+	void world_streamer_t::collect_finished()
+	{
+		std::vector<slot_t*> done;
+		{
+			std::lock_guard<std::mutex> guard(queue_lock);
+			done.swap(finished);
+		}
+
+		for (slot_t* slot : done)
+		{
+			slot->resident = true;
+			counters.resident_cells++;
+			counters.resident_bytes += slot->cell.bytes;
+			counters.loads++;
+		}
+	}
+
+	void world_streamer_t::gather_wanted(const float3& center, float radius, float bias, std::vector<wanted_t>& out)const
+	{
+		float cs = config.cell_size;
+		int32_t x0 = world_cell_coord(center.x - radius, cs), x1 = world_cell_coord(center.x + radius, cs);
+		int32_t z0 = world_cell_coord(center.z - radius, cs), z1 = world_cell_coord(center.z + radius, cs);
+
+		for (int32_t z = z0; z <= z1; z++)
+		{
+			for (int32_t x = x0; x <= x1; x++)
+			{
+				float d = cell_distance(center, x, z, cs);
+				if (d <= radius)
+					out.push_back({ cell_key(x, z), x, z, d + bias });
+			}
+		}
+	}
+
+	void world_streamer_t::evict(uint64_t key, bool for_budget)
+	{
+		auto it = cells.find(key);
+		if (it == cells.end() || !it->second->resident)
+			return;
+
+		counters.resident_cells--;
+		counters.resident_bytes -= it->second->cell.bytes;
+		counters.evictions++;
+		if (for_budget)
+			counters.budget_evictions++;
+		cells.erase(it);
+	}
+
+	void world_streamer_t::io_loop()
+	{
+		profiler::set_thread_name("world io");
+
+		for (;;)
+		{
+			slot_t* slot;
+			{
+				std::unique_lock<std::mutex> lock(queue_lock);
+				request_ready.wait(lock, [this] { return quit || !requests.empty(); });
+				if (quit)
+					return;
+
+				slot = requests.front();
+				requests.pop_front();
+				slot->state = CELL_LOADING;
+				loading++;
+			}
+
+			{
+				PROFILE_SCOPE("load cell");
+
+				cell_t& c = slot->cell;
+				std::string path = world_cell_path(config.directory, c.x, c.z);
+				if (c.scene.open(path.c_str()))
+				{
+					// Paged in here so culling never faults on a cell it was handed
+					aabb_soa_view_t b = c.scene.bounds();
+					size_t n = c.scene.object_count();
+					for (const float* a : { b.min_x, b.min_y, b.min_z, b.max_x, b.max_y, b.max_z })
+						touch_pages(a, n * sizeof(float));
+					if (c.scene.transforms())
+						touch_pages(c.scene.transforms(), n * sizeof(float4x4));
+					if (c.scene.flags())
+						touch_pages(c.scene.flags(), n * sizeof(uint32_t));
+
+					// The budget pays for the whole mapping, not just the arrays read
+					c.bytes = c.scene.file_size();
+				}
+			}
+
+			{
+				std::lock_guard<std::mutex> guard(queue_lock);
+				slot->state = CELL_READY;
+				loading--;
+				finished.push_back(slot);
+			}
+			load_finished.notify_all();
+		}
+	}
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "math_types.h"
+#include "scene_file.h"
+
+namespace end
+{
+	struct world_stream_settings_t
+	{
+		std::string directory = "world";	// holds cell_X_Z.bin scene files, see world_cell_path
+		float cell_size = 64.0f;			// square cells on the XZ plane
+		float load_radius = 160.0f;			// cells closer than this to the camera are loaded
+		float unload_radius = 224.0f;		// and kept until farther than this, so edge cells don't flicker
+		float prefetch_seconds = 1.0f;		// also loads around where the camera will be this far ahead
+		size_t memory_budget = 256u << 20;	// bytes of resident cells
+		size_t max_in_flight = 8;			// queued or loading cells
+		int io_threads = 2;
+	};
+
+	struct world_stream_stats_t
+	{
+		size_t resident_cells = 0;
+		size_t resident_bytes = 0;
+		size_t in_flight = 0;
+		size_t loads = 0;				// totals since construction
+		size_t evictions = 0;
+		size_t budget_evictions = 0;	// evicted while still in range to make room for nearer cells
+	};
+
+	// Path of the cell at grid coordinates x, z
+	std::string world_cell_path(const std::string& directory, int32_t x, int32_t z);
+
+	// Grid coordinate of a world position along one axis
+	int32_t world_cell_coord(float position, float cell_size);
+
+	// Pages world cells in and out around the camera.
+	//
+	//	The world is a grid of cells, each a scene file (missing files are empty cells).
+	//	update() runs on the main thread once a frame: it picks the cells within load_radius of the
+	//	camera and of the position predicted from its velocity, nearest first, queues the missing
+	//	ones for the I/O threads and evicts cells past unload_radius. I/O threads map a cell and touch
+	//	every page; the cell only shows up in ready_cells() on the update() after it fully finished.
+	//	Over the memory budget a cell is only loaded if it's nearer than the farthest resident cell,
+	//	which is evicted for it, so a full budget keeps the nearest cells without thrashing.
+	//	Work per update depends on the radii and the cell size, not on how big the world is.
+	class world_streamer_t
+	{
+	public:
+
+		struct cell_t
+		{
+			int32_t x = 0;
+			int32_t z = 0;
+			scene_file_t scene;		// not open for empty cells
+			size_t bytes = 0;		// mapped file size, header, section table and padding included
+			float distance = 0.0f;	// priority from the last update, 0 inside the cell
+		};
+
+		explicit world_streamer_t(const world_stream_settings_t& settings = {});
+		~world_streamer_t();
+
+		world_streamer_t(const world_streamer_t&) = delete;
+		world_streamer_t& operator=(const world_streamer_t&) = delete;
+
+		// position is the camera's, dt the frame time used for its velocity
+		void update(const float3& position, float dt);
+
+		// Fully loaded, non empty cells as of the last update(), valid until the next one
+		const std::vector<const cell_t*>& ready_cells()const { return ready; }
+
+		const world_stream_stats_t& stats()const { return counters; }
+		const world_stream_settings_t& settings()const { return config; }
+
+		// Blocks until nothing is queued or loading, then runs update() at position with dt 0
+		void flush(const float3& position);
+
+	private:
+
+		enum cell_state_t : uint8_t
+		{
+			CELL_QUEUED,
+			CELL_LOADING,
+			CELL_READY
+		};
+
+		struct slot_t
+		{
+			cell_t cell;
+			cell_state_t state = CELL_QUEUED;	// written under queue_lock
+			bool resident = false;				// loaded and counted by update()
+		};
+
+		struct wanted_t
+		{
+			uint64_t key;
+			int32_t x, z;
+			float distance;
+		};
+
+		void io_loop();
+		void collect_finished();
+		void gather_wanted(const float3& center, float radius, float bias, std::vector<wanted_t>& out)const;
+		void evict(uint64_t key, bool for_budget);
+
+		world_stream_settings_t config;
+
+		float3 last_position = { 0.0f, 0.0f, 0.0f };
+		float3 velocity = { 0.0f, 0.0f, 0.0f };
+		bool has_position = false;
+
+		// Main thread only, except slot_t::state and the queues
+		std::unordered_map<uint64_t, std::unique_ptr<slot_t>> cells;
+		std::vector<const cell_t*> ready;
+		std::vector<wanted_t> wanted;
+		world_stream_stats_t counters;
+
+		std::deque<slot_t*> requests;	// nearest first, rebuilt every update
+		std::vector<slot_t*> finished;
+		size_t loading = 0;
+		std::mutex queue_lock;
+		std::condition_variable request_ready;
+		std::condition_variable load_finished;
+		bool quit = false;
+
+		std::vector<std::thread> io_threads;
+	};
+}
@@ -0,0 +1,59 @@
+// Packs loose asset files into one archive for asset_loader_t::mount.
+//
+//	asset_packer [-c] <archive> <file>...
+//
+//	Each file is stored under the name it was given on the command line,
+//	e.g. run from the output directory: asset_packer shaders.pak vs_cube.cso ps_cube.cso ...
+//	-c compresses every file that gets smaller (decompressed by the loader as it reads them).
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "archive.h"
+#include "job_system.h"
+
+int main(int argc, char** argv)
+{
+	int first = 1;
+	bool compress = argc > 1 && strcmp(argv[1], "-c") == 0;
+	if (compress)
+		first++;
+
+	if (argc - first < 2)
+	{
+		printf("usage: asset_packer [-c] <archive> <file>...\n");
+		return 1;
+	}
+
+	const char* archive_path = argv[first];
+	std::vector<end::archive_input_t> inputs;
+	size_t total = 0;
+	for (int i = first + 1; i < argc; i++)
+	{
+		end::archive_input_t input;
+		input.name = argv[i];
+		input.compress = compress;
+		input.data = end::load_binary_blob(argv[i]);
+		if (input.data.empty())
+		{
+			printf("asset_packer: can't read %s\n", argv[i]);
+			return 1;
+		}
+
+		total += input.data.size();
+		inputs.push_back(std::move(input));
+	}
+
+	end::job_system_t jobs;
+	std::string error;
+	if (!end::write_archive(archive_path, inputs, &error, &jobs))
+	{
+		printf("asset_packer: %s\n", error.c_str());
+		return 1;
+	}
+
+	end::mapped_blob_t written = end::map_binary_blob(archive_path);
+	printf("%s: %zu files, %zu bytes, %zu bytes on disk\n", archive_path, inputs.size(), total, written.size());
+	return 0;
+}
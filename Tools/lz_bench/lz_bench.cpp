@@ -0,0 +1,162 @@
+// Times loading an asset stored raw against stored compressed.
+//
+//	lz_bench <file> [iterations]
+//
+//	Packs the file into a raw and a compressed archive next to it, then times reading the raw file,
+//	extracting the raw entry and extracting the compressed entry on one thread and on the job system.
+//	Every pass reopens the archive. The OS file cache stays warm, so this measures decompression
+//	cost against copying; reading from a cold disk the compressed archive also moves ratio x fewer bytes.
+//	The checksum pass the asset loader runs first is timed on its own, the extracted bytes are
+//	compared with the file after the timing.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "archive.h"
+#include "job_system.h"
+
+namespace
+{
+	using clock_type = std::chrono::steady_clock;
+
+	double seconds_since(clock_type::time_point start)
+	{
+		return std::chrono::duration<double>(clock_type::now() - start).count();
+	}
+
+	// Best of the passes, in MB/s of loaded bytes. 0 if any pass failed.
+	template <typename F>
+	double best_rate(size_t bytes, int iterations, F&& load)
+	{
+		double best = 0.0;
+		for (int i = 0; i < iterations; i++)
+		{
+			clock_type::time_point start = clock_type::now();
+			if (!load())
+				return 0.0;
+			double t = seconds_since(start);
+			if (best == 0.0 || t < best)
+				best = t;
+		}
+		return best > 0.0 ? bytes / best / 1e6 : 0.0;
+	}
+
+	// out is sized by the caller, no checksum or compare in here
+	bool extract(const char* path, const char* name, end::binary_blob_t& out, end::job_system_t* jobs)
+	{
+		end::archive_t archive;
+		if (!archive.open(path))
+			return false;
+
+		const end::archive_entry_t* entry = archive.find(name);
+		return entry && entry->size == out.size() && archive.extract(*entry, out.data(), jobs);
+	}
+
+	bool verify(const char* path, const char* name, end::job_system_t* jobs)
+	{
+		end::archive_t archive;
+		if (!archive.open(path))
+			return false;
+
+		const end::archive_entry_t* entry = archive.find(name);
+		return entry && archive.verify(*entry, jobs);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		printf("usage: lz_bench <file> [iterations]\n");
+		return 1;
+	}
+
+	const char* path = argv[1];
+	int iterations = argc > 2 ? atoi(argv[2]) : 10;
+	if (iterations < 1)
+		iterations = 1;
+
+	end::binary_blob_t data = end::load_binary_blob(path);
+	if (data.empty())
+	{
+		printf("lz_bench: can't read %s\n", path);
+		return 1;
+	}
+
+	std::string raw_path = std::string(path) + ".raw.pak";
+	std::string packed_path = std::string(path) + ".lz.pak";
+
+	end::job_system_t jobs;
+	std::vector<end::archive_input_t> inputs(1);
+	inputs[0].name = "asset";
+	inputs[0].data = data;
+
+	bool ok = end::write_archive(raw_path.c_str(), inputs, nullptr);
+	inputs[0].compress = true;
+	clock_type::time_point start = clock_type::now();
+	ok = ok && end::write_archive(packed_path.c_str(), inputs, nullptr, &jobs);
+	double pack_time = seconds_since(start);
+	if (!ok)
+	{
+		printf("lz_bench: can't write the archives next to %s\n", path);
+		return 1;
+	}
+
+	end::archive_t packed;
+	const end::archive_entry_t* entry = packed.open(packed_path.c_str()) ? packed.find("asset") : nullptr;
+	if (!entry)
+	{
+		printf("lz_bench: can't read back %s\n", packed_path.c_str());
+		remove(raw_path.c_str());
+		remove(packed_path.c_str());
+		return 1;
+	}
+	double ratio = (double)entry->stored_size / (double)entry->size;
+	bool compressed = (entry->flags & end::ARCHIVE_COMPRESSED) != 0;
+	packed.close();
+
+	size_t bytes = data.size();
+	end::binary_blob_t out(bytes);
+	bool matches = true;
+
+	// Each extraction is compared once its timing is done
+	double file_rate = best_rate(bytes, iterations, [&] { return end::load_binary_blob(path).size() == bytes; });
+	double raw_rate = best_rate(bytes, iterations, [&] { return extract(raw_path.c_str(), "asset", out, nullptr); });
+	matches = matches && out == data;
+	double serial_rate = best_rate(bytes, iterations, [&] { return extract(packed_path.c_str(), "asset", out, nullptr); });
+	matches = matches && out == data;
+	double parallel_rate = best_rate(bytes, iterations, [&] { return extract(packed_path.c_str(), "asset", out, &jobs); });
+	matches = matches && out == data;
+
+	// Rates of the checksum pass over the stored bytes, reported against the loaded size like the rest
+	double verify_serial_rate = best_rate(bytes, iterations, [&] { return verify(packed_path.c_str(), "asset", nullptr); });
+	double verify_parallel_rate = best_rate(bytes, iterations, [&] { return verify(packed_path.c_str(), "asset", &jobs); });
+
+	remove(raw_path.c_str());
+	remove(packed_path.c_str());
+
+	printf("%s: %zu bytes, stored %.1f%%%s, packed in %.1f ms on %u threads\n", path, bytes, ratio * 100.0,
+		compressed ? "" : " (kept raw, didn't compress)", pack_time * 1000.0, jobs.thread_count());
+	printf("  loose file read        %8.0f MB/s\n", file_rate);
+	printf("  raw archive entry      %8.0f MB/s\n", raw_rate);
+	printf("  compressed, 1 thread   %8.0f MB/s\n", serial_rate);
+	printf("  compressed, %2u threads %8.0f MB/s\n", jobs.thread_count(), parallel_rate);
+	printf("  checksum, 1 thread     %8.0f MB/s\n", verify_serial_rate);
+	printf("  checksum, %2u threads   %8.0f MB/s\n", jobs.thread_count(), verify_parallel_rate);
+
+	if (file_rate == 0.0 || raw_rate == 0.0 || serial_rate == 0.0 || parallel_rate == 0.0 ||
+		verify_serial_rate == 0.0 || verify_parallel_rate == 0.0)
+	{
+		printf("lz_bench: a pass failed\n");
+		return 1;
+	}
+	if (!matches)
+	{
+		printf("lz_bench: extracted bytes didn't match the original\n");
+		return 1;
+	}
+	return 0;
+}
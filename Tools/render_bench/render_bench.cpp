@@ -0,0 +1,237 @@
+// Runs the renderer's frame without a window along a camera path and reports CPU times per stage.
+//
+//	render_bench <camera path> [-frames N] [-warmup N] [-dt seconds] [-boxes N] [-scene file]
+//	             [-backend null|software] [-size WxH] [-json report.json] [-ppm last_frame.ppm]
+//	             [-trace trace.json] [-csv frame_stats.csv]
+//
+//	Frame i places both cameras at path time i * dt (camera_path.h, record one with CAMERA_RECORD)
+//	and simulates with dt instead of the clock, so two runs see the same frames. Warmup frames are
+//	drawn first and left out of the numbers. Frame times are the wall time of renderer_t::draw, stage
+//	times come from the renderer's frame_stats_t series. -boxes generates that many boxes in place
+//	of the scene file; the particle emitters are compiled out of the renderer and aren't scaled.
+//	-trace and -csv have the renderer write its profiler trace and per frame stats on exit.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "camera_path.h"
+#include "frame_stats.h"
+#include "null_backend.h"
+#include "renderer.h"
+#include "software_backend.h"
+
+namespace
+{
+	using clock_type = std::chrono::steady_clock;
+
+	struct options_t
+	{
+		const char* path = nullptr;
+		int frames = 600;
+		int warmup = 30;
+		float dt = 1.0f / 60.0f;
+		end::renderer_settings_t settings;
+		bool software = false;
+		uint32_t width = 1280;
+		uint32_t height = 720;
+		const char* json = nullptr;
+		const char* ppm = nullptr;
+	};
+
+	bool parse(int argc, char** argv, options_t& out)
+	{
+		if (argc < 2)
+			return false;
+		out.path = argv[1];
+
+		for (int i = 2; i < argc; i++)
+		{
+			const char* arg = argv[i];
+			const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+			if (!value)
+				return false;
+			i++;
+
+			if (strcmp(arg, "-frames") == 0)
+				out.frames = atoi(value);
+			else if (strcmp(arg, "-warmup") == 0)
+				out.warmup = atoi(value);
+			else if (strcmp(arg, "-dt") == 0)
+				out.dt = (float)atof(value);
+			else if (strcmp(arg, "-boxes") == 0)
+				out.settings.box_count = (size_t)strtoull(value, nullptr, 10);
+			else if (strcmp(arg, "-scene") == 0)
+				out.settings.scene_path = value;
+			else if (strcmp(arg, "-backend") == 0 && strcmp(value, "null") == 0)
+				out.software = false;
+			else if (strcmp(arg, "-backend") == 0 && strcmp(value, "software") == 0)
+				out.software = true;
+			else if (strcmp(arg, "-size") == 0)
+			{
+				if (sscanf(value, "%ux%u", &out.width, &out.height) != 2 || out.width == 0 || out.height == 0)
+					return false;
+			}
+			else if (strcmp(arg, "-json") == 0)
+				out.json = value;
+			else if (strcmp(arg, "-ppm") == 0)
+				out.ppm = value;
+			else if (strcmp(arg, "-trace") == 0)
+				out.settings.trace_path = value;
+			else if (strcmp(arg, "-csv") == 0)
+				out.settings.frame_stats_path = value;
+			else
+				return false;
+		}
+		return out.frames > 0 && out.warmup >= 0 && out.dt > 0.0f;
+	}
+
+	// Paths can hold backslashes and quotes
+	std::string json_string(const char* text)
+	{
+		std::string out = "\"";
+		for (const char* c = text; *c; c++)
+		{
+			if (*c == '\\' || *c == '"')
+				out += '\\';
+			out += *c;
+		}
+		return out + "\"";
+	}
+
+	void print_row(const end::frame_stats_snapshot_t& s)
+	{
+		printf("  %-12s %10.3f %10.3f %10.3f %10.3f %10.3f\n", s.name.c_str(),
+			s.mean * 1e3, s.p50 * 1e3, s.p95 * 1e3, s.p99 * 1e3, s.max * 1e3);
+	}
+
+	void write_stage(FILE* file, const end::frame_stats_snapshot_t& s, bool last)
+	{
+		fprintf(file, "    { \"name\": \"%s\", \"count\": %llu, \"mean_ms\": %.4f, \"p50_ms\": %.4f, \"p95_ms\": %.4f, \"p99_ms\": %.4f, \"max_ms\": %.4f, \"hitches\": %llu }%s\n",
+			s.name.c_str(), (unsigned long long)s.count, s.mean * 1e3, s.p50 * 1e3, s.p95 * 1e3, s.p99 * 1e3, s.max * 1e3,
+			(unsigned long long)s.hitches, last ? "" : ",");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	options_t options;
+	if (!parse(argc, argv, options))
+	{
+		printf("usage: render_bench <camera path> [-frames N] [-warmup N] [-dt seconds] [-boxes N] [-scene file]\n"
+			"                    [-backend null|software] [-size WxH] [-json report.json] [-ppm last_frame.ppm]\n"
+			"                    [-trace trace.json] [-csv frame_stats.csv]\n");
+		return 1;
+	}
+
+	end::camera_path_t path;
+	std::string error;
+	if (!path.load(options.path, &error))
+	{
+		printf("render_bench: %s\n", error.c_str());
+		return 1;
+	}
+
+	end::null_backend_t* null_backend = nullptr;
+	end::software_backend_t* software_backend = nullptr;
+	std::unique_ptr<end::render_backend_t> backend;
+	if (options.software)
+		backend.reset(software_backend = new end::software_backend_t(options.width, options.height));
+	else
+		backend.reset(null_backend = new end::null_backend_t(options.width, options.height));
+
+	end::renderer_t renderer(std::move(backend), options.settings);
+
+	// The renderer's series are stages, this one is the whole draw
+	end::frame_stats_t frames(1.0 / 30.0, 1.0, 1);
+
+	clock_type::time_point run_start = clock_type::now();
+	for (int i = -options.warmup; i < options.frames; i++)
+	{
+		// Warmup frames fly the start of the path too
+		int frame = i < 0 ? i + options.warmup : i;
+		end::camera_key_t key = path.sample(frame * options.dt);
+
+		if (i == 0)
+		{
+			if (end::frame_stats_t* stats = renderer.stats())
+				stats->reset();
+			if (null_backend)
+				null_backend->reset_counters();
+			run_start = clock_type::now();
+		}
+
+		clock_type::time_point start = clock_type::now();
+		renderer.draw(key, options.dt);
+		if (i >= 0)
+			frames.record_frame(std::chrono::duration<double>(clock_type::now() - start).count());
+	}
+	double run_time = std::chrono::duration<double>(clock_type::now() - run_start).count();
+
+	end::frame_stats_snapshot_t frame = frames.snapshot(end::frame_stats_t::FRAME, end::frame_stats_t::ALL);
+	frame.name = "frame";
+
+	// Series 0 of the renderer's stats is its own frame time, clock to clock, the stages follow it
+	std::vector<end::frame_stats_snapshot_t> stages;
+	if (end::frame_stats_t* stats = renderer.stats())
+	{
+		for (size_t s = 1; s < stats->series_count(); s++)
+			stages.push_back(stats->snapshot(s, end::frame_stats_t::ALL));
+	}
+
+	printf("%s: %d frames (+%d warmup) at dt %.4f, %s backend %ux%u, %.1f fps\n", options.path, options.frames, options.warmup,
+		options.dt, options.software ? "software" : "null", options.width, options.height, options.frames / run_time);
+	printf("  %-12s %10s %10s %10s %10s %10s\n", "ms", "mean", "p50", "p95", "p99", "max");
+	print_row(frame);
+	for (const end::frame_stats_snapshot_t& s : stages)
+		print_row(s);
+
+	if (options.ppm && software_backend && !software_backend->write_ppm(options.ppm, &error))
+	{
+		printf("render_bench: %s\n", error.c_str());
+		return 1;
+	}
+
+	if (options.json)
+	{
+		FILE* file = fopen(options.json, "w");
+		if (!file)
+		{
+			printf("render_bench: can't open %s\n", options.json);
+			return 1;
+		}
+
+		fprintf(file, "{\n");
+		fprintf(file, "  \"path\": %s,\n", json_string(options.path).c_str());
+		fprintf(file, "  \"path_keys\": %zu,\n", path.key_count());
+		fprintf(file, "  \"backend\": \"%s\",\n", options.software ? "software" : "null");
+		fprintf(file, "  \"width\": %u,\n  \"height\": %u,\n", options.width, options.height);
+		fprintf(file, "  \"frames\": %d,\n  \"warmup\": %d,\n  \"dt\": %.6f,\n", options.frames, options.warmup, options.dt);
+		fprintf(file, "  \"boxes\": %zu,\n", options.settings.box_count);
+		fprintf(file, "  \"seconds\": %.6f,\n  \"fps\": %.3f,\n", run_time, options.frames / run_time);
+		if (null_backend)
+		{
+			const end::render_counters_t& c = null_backend->counters();
+			fprintf(file, "  \"draw_calls\": %llu,\n  \"vertices\": %llu,\n  \"upload_bytes\": %llu,\n",
+				(unsigned long long)c.draw_calls, (unsigned long long)c.vertices, (unsigned long long)c.upload_bytes);
+		}
+		if (software_backend)
+			fprintf(file, "  \"last_frame_primitives\": %zu,\n", software_backend->primitive_count());
+
+		fprintf(file, "  \"stages\": [\n");
+		write_stage(file, frame, stages.empty());
+		for (size_t s = 0; s < stages.size(); s++)
+			write_stage(file, stages[s], s + 1 == stages.size());
+		fprintf(file, "  ]\n}\n");
+
+		if (fclose(file) != 0)
+		{
+			printf("render_bench: write failed: %s\n", options.json);
+			return 1;
+		}
+	}
+	return 0;
+}
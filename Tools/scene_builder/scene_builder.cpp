@@ -0,0 +1,175 @@
+// Generates a large static test scene for the renderer (scene.bin), world streaming or the benchmarks.
+//
+//	scene_builder <scene file> <object count> [seed]
+//	scene_builder -world <directory> <object count> [cell size] [seed]
+//
+//	Boxes stand on a square grid 4 units apart, centered on the origin, with random footprints
+//	and heights. Tall ones are flagged as occluders. Same seed, same scene.
+//	-world splits the boxes by their center into the cell_X_Z.bin files world_streamer_t pages in.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "random.h"
+#include "scene_file.h"
+#include "world_stream.h"
+
+namespace
+{
+	struct scene_arrays_t
+	{
+		end::aabb_soa_t bounds;
+		std::vector<end::float4x4> transforms;
+		std::vector<uint32_t> flags;
+
+		void resize(size_t n)
+		{
+			bounds.resize(n);
+			transforms.resize(n);
+			flags.resize(n);
+		}
+
+		void copy(size_t to, const scene_arrays_t& from, size_t index)
+		{
+			bounds.set(to, from.bounds.get(index));
+			transforms[to] = from.transforms[index];
+			flags[to] = from.flags[index];
+		}
+
+		bool write(const char* path, std::string* error)const
+		{
+			end::scene_data_t scene;
+			scene.bounds = bounds.view();
+			scene.transforms = transforms.data();
+			scene.flags = flags.data();
+			return end::write_scene_file(path, scene, error);
+		}
+	};
+
+	size_t generate(scene_arrays_t& out, size_t count, uint64_t seed)
+	{
+		const float spacing = 4.0f;
+		size_t side = (size_t)std::ceil(std::sqrt((double)count));
+		float origin = -0.5f * spacing * side;
+
+		out.resize(count);
+		end::rng_t rng(seed);
+		for (size_t i = 0; i < count; i++)
+		{
+			float x = origin + spacing * (i % side);
+			float z = origin + spacing * (i / side);
+			float half_width = rng.range(0.5f, 1.5f);
+			float half_depth = rng.range(0.5f, 1.5f);
+			float height = rng.range(1.0f, 8.0f);
+
+			out.bounds.set(i, { { x - half_width, 0.0f, z - half_depth }, { x + half_width, height, z + half_depth } });
+
+			end::float4x4& m = out.transforms[i];
+			m[0] = { 1.0f, 0.0f, 0.0f, 0.0f };
+			m[1] = { 0.0f, 1.0f, 0.0f, 0.0f };
+			m[2] = { 0.0f, 0.0f, 1.0f, 0.0f };
+			m[3] = { x, 0.5f * height, z, 1.0f };
+
+			out.flags[i] = end::SCENE_OBJECT_PICKABLE | (height > 5.0f ? end::SCENE_OBJECT_OCCLUDER : 0);
+		}
+		return side;
+	}
+
+	int write_world(const char* directory, const scene_arrays_t& all, float cell_size)
+	{
+		struct placed_t
+		{
+			int32_t x, z;
+			uint32_t index;
+		};
+
+		size_t count = all.bounds.size();
+		std::vector<placed_t> placed(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			end::float3 c = all.bounds.get(i).center();
+			placed[i] = { end::world_cell_coord(c.x, cell_size), end::world_cell_coord(c.z, cell_size), (uint32_t)i };
+		}
+		std::sort(placed.begin(), placed.end(), [](const placed_t& a, const placed_t& b)
+			{ return a.z != b.z ? a.z < b.z : a.x != b.x ? a.x < b.x : a.index < b.index; });
+
+		std::error_code ec;
+		std::filesystem::create_directories(directory, ec);
+
+		size_t cell_count = 0;
+		scene_arrays_t cell;
+		for (size_t first = 0; first < count;)
+		{
+			size_t last = first;
+			while (last < count && placed[last].x == placed[first].x && placed[last].z == placed[first].z)
+				last++;
+
+			cell.resize(last - first);
+			for (size_t i = first; i < last; i++)
+				cell.copy(i - first, all, placed[i].index);
+
+			std::string error;
+			std::string path = end::world_cell_path(directory, placed[first].x, placed[first].z);
+			if (!cell.write(path.c_str(), &error))
+			{
+				printf("scene_builder: %s\n", error.c_str());
+				return 1;
+			}
+
+			cell_count++;
+			first = last;
+		}
+
+		printf("%s: %zu objects in %zu cells of %g units\n", directory, count, cell_count, cell_size);
+		return 0;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bool world = argc > 1 && strcmp(argv[1], "-world") == 0;
+	int first = world ? 2 : 1;
+
+	if (argc - first < 2)
+	{
+		printf("usage: scene_builder <scene file> <object count> [seed]\n");
+		printf("       scene_builder -world <directory> <object count> [cell size] [seed]\n");
+		return 1;
+	}
+
+	const char* path = argv[first];
+	size_t count = (size_t)strtoull(argv[first + 1], nullptr, 10);
+	int next = first + 2;
+
+	float cell_size = 64.0f;
+	if (world && argc > next)
+		cell_size = (float)atof(argv[next++]);
+	uint64_t seed = argc > next ? strtoull(argv[next], nullptr, 10) : 5;
+
+	if (cell_size <= 0.0f)
+	{
+		printf("scene_builder: cell size must be positive\n");
+		return 1;
+	}
+
+	scene_arrays_t all;
+	size_t side = generate(all, count, seed);
+
+	if (world)
+		return write_world(path, all, cell_size);
+
+	std::string error;
+	if (!all.write(path, &error))
+	{
+		printf("scene_builder: %s\n", error.c_str());
+		return 1;
+	}
+
+	printf("%s: %zu objects on a %zux%zu grid\n", path, count, side, side);
+	return 0;
+}